@@ -0,0 +1,120 @@
+// Block-compressed spill runs vs raw ones, with the codec picked at build
+// time (lz4 / zstd / none). First the run format alone: compression ratio of
+// a sorted run and how fast a CompressedRunSet hands out records as its
+// decompression pool grows. Then external sorts with raw and compressed
+// spills and outputs: bytes moved and end-to-end time.
+//
+// Keys are random with `key_bits` significant bits, so the ratio can be
+// dialled from incompressible (64) to highly redundant.
+//
+// usage: bench_compressed_runs [records] [memory_limit_mb] [block_kb] [key_bits] [temp_dir]
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "bench_util.hpp"
+#include "nway/compressed_run.hpp"
+#include "nway/external_sort.hpp"
+#include "nway/run_file.hpp"
+
+namespace {
+
+double mib(std::uint64_t bytes) { return bytes / double(1 << 20); }
+
+const char* name(nway::SpillFormat format) {
+  return format == nway::SpillFormat::compressed ? "compressed" : "raw";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t records = bench::arg_size(argc, argv, 1, std::size_t(1) << 24);
+  nway::ExternalSortOptions base;
+  base.memory_limit = bench::arg_size(argc, argv, 2, 16) << 20;
+  base.write_buffer = bench::arg_size(argc, argv, 3, 256) << 10;
+  base.read_buffer = base.write_buffer;
+  const unsigned key_bits = static_cast<unsigned>(
+      std::clamp<std::size_t>(bench::arg_size(argc, argv, 4, 40), 1, 64));
+  if (argc > 5) base.temp_dir = argv[5];
+  const auto draw = [key_bits](std::mt19937_64& rng) { return rng() >> (64 - key_bits); };
+
+  nway::TempDir dir(base.temp_dir);
+  std::printf("codec %s, %zu KiB blocks, %u-bit keys\n",
+              nway::to_string(nway::default_block_codec()), base.write_buffer >> 10, key_bits);
+
+  {
+    const std::size_t n = std::min<std::size_t>(records, std::size_t(1) << 22);
+    std::vector<std::uint64_t> keys(n);
+    std::mt19937_64 rng(11);
+    for (auto& k : keys) k = draw(rng);
+    std::sort(keys.begin(), keys.end());
+    const auto path = dir.path() / "codec.bin";
+    bench::Timer enc;
+    nway::CompressedRunWriter<std::uint64_t> w(path, base.write_buffer);
+    w.write(keys.data(), n);
+    w.finish();
+    const double raw = double(n * sizeof(std::uint64_t));
+    std::printf("%zu sorted keys: %.2fx smaller, encode %.0f MiB/s\n", n,
+                raw / double(w.bytes_written()), raw / (1 << 20) / enc.seconds());
+
+    const std::size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    for (std::size_t workers = 1; workers <= cores; workers *= 2) {
+      bench::Timer dec;
+      nway::CompressedRunSet<std::uint64_t> set({path}, workers);
+      auto& c = set.cursors()[0];
+      std::size_t i = 0;
+      for (; !c.empty(); c.pop(), ++i) bench::check(c.front() == keys[i], "decode mismatch");
+      bench::check(i == n, "decode lost keys");
+      std::printf("  %2zu workers: %7.0f MiB/s of raw keys at the cursor\n", workers,
+                  raw / (1 << 20) / dec.seconds());
+    }
+  }
+
+  const auto input = dir.path() / "input.bin";
+  {
+    nway::RunWriter<std::uint64_t> w(input, std::size_t(1) << 20);
+    std::mt19937_64 rng(1);
+    for (std::size_t i = 0; i < records; ++i) w.push(draw(rng));
+    w.finish();
+  }
+  std::printf("\nexternal sort of %zu uint64 (%.0f MiB), %zu MiB budget\n", records,
+              mib(records * 8), base.memory_limit >> 20);
+  std::printf("%-10s %-10s %6s %6s %6s %12s %12s %8s %8s\n", "spill", "output", "runs",
+              "fan-in", "passes", "read", "written", "phase 1", "total");
+  using F = nway::SpillFormat;
+  for (auto [spill, out] : {std::pair{F::raw, F::raw}, std::pair{F::compressed, F::raw},
+                            std::pair{F::compressed, F::compressed}}) {
+    nway::ExternalSortOptions opts = base;
+    opts.spill_format = spill;
+    opts.output_format = out;
+    const auto output = dir.path() / "output.bin";
+    bench::Timer t;
+    const auto stats = nway::external_sort<std::uint64_t>(input, output, opts);
+    const double secs = t.seconds();
+
+    std::uint64_t n = 0, prev = 0;
+    const auto verify = [&](auto& cursor) {
+      for (; !cursor.empty(); cursor.pop(), ++n) {
+        bench::check(cursor.front() >= prev, "output not sorted");
+        prev = cursor.front();
+      }
+    };
+    if (out == F::compressed) {
+      nway::CompressedRunSet<std::uint64_t> set({output});
+      verify(set.cursors()[0]);
+    } else {
+      nway::RunReader<std::uint64_t> reader(output, std::size_t(1) << 20);
+      verify(reader);
+    }
+    bench::check(n == records, "output lost records");
+    std::filesystem::remove(output);
+
+    std::printf("%-10s %-10s %6zu %6zu %6zu %8.1f MiB %8.1f MiB %7.2fs %7.2fs\n", name(spill),
+                name(out), stats.initial_runs, stats.fan_in, stats.merge_passes,
+                mib(stats.bytes_read), mib(stats.bytes_written), stats.run_generation_seconds,
+                secs);
+  }
+}
@@ -0,0 +1,88 @@
+// External sort of a file of random uint64 keys under a memory limit.
+//
+// usage: bench_external_sort [records] [memory_limit_mb] [read_buffer_kb] [temp_dir]
+//                            [sort_threads] [overlap_io]
+//
+// Prints the busy time and throughput of each run generation stage (read,
+// sort, write); the slowest one bounds phase 1 when the stages overlap.
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "bench_util.hpp"
+#include "nway/detail/file.hpp"
+#include "nway/external_sort.hpp"
+#include "nway/run_file.hpp"
+
+namespace {
+
+long peak_rss_kb() {
+  rusage ru;
+  getrusage(RUSAGE_SELF, &ru);
+  return ru.ru_maxrss;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t records = bench::arg_size(argc, argv, 1, std::size_t(1) << 25);
+  nway::ExternalSortOptions opts;
+  opts.memory_limit = bench::arg_size(argc, argv, 2, 32) << 20;
+  opts.read_buffer = bench::arg_size(argc, argv, 3, 256) << 10;
+  opts.write_buffer = opts.read_buffer;
+  if (argc > 4) opts.temp_dir = argv[4];
+  opts.sort_threads = bench::arg_size(argc, argv, 5, 0);
+  opts.overlap_io = bench::arg_size(argc, argv, 6, 1) != 0;
+
+  nway::TempDir dir(opts.temp_dir);
+  const auto input = dir.path() / "input.bin";
+  const auto output = dir.path() / "output.bin";
+  {
+    nway::RunWriter<std::uint64_t> w(input, std::size_t(1) << 20);
+    std::mt19937_64 rng(1);
+    for (std::size_t i = 0; i < records; ++i) w.push(rng());
+    w.finish();
+  }
+  const long rss_before = peak_rss_kb();
+
+  bench::Timer t;
+  const auto stats = nway::external_sort<std::uint64_t>(input, output, opts);
+  const double secs = t.seconds();
+
+  nway::RunReader<std::uint64_t> check(output, std::size_t(1) << 20);
+  std::uint64_t n = 0, prev = 0;
+  for (; !check.empty(); check.pop(), ++n) {
+    bench::check(check.front() >= prev, "output not sorted");
+    prev = check.front();
+  }
+  bench::check(n == records, "output lost records");
+
+  std::printf("records         %llu (%.1f MiB)\n", (unsigned long long)stats.records,
+              stats.records * 8.0 / (1 << 20));
+  std::printf("memory limit    %zu MiB, read buffer %zu KiB\n", opts.memory_limit >> 20,
+              opts.read_buffer >> 10);
+  std::printf("run generation  %.2f s, %s, %zu sort threads\n", stats.run_generation_seconds,
+              opts.overlap_io ? "pipelined" : "sequential",
+              opts.sort_threads ? opts.sort_threads : std::max(1u, std::thread::hardware_concurrency()));
+  const double mib = stats.records * 8.0 / (1 << 20);
+  const std::pair<const char*, double> stages[] = {
+      {"read", stats.read_seconds}, {"sort", stats.sort_seconds}, {"write", stats.write_seconds}};
+  for (const auto& [name, busy] : stages)
+    std::printf("  %-6s        %.2f s busy, %.1f MiB/s\n", name, busy, busy > 0 ? mib / busy : 0.0);
+  std::printf("  bottleneck    %s\n",
+              std::ranges::max_element(stages, {}, [](const auto& s) { return s.second; })->first);
+  std::printf("initial runs    %zu\n", stats.initial_runs);
+  std::printf("fan-in          %zu\n", stats.fan_in);
+  std::printf("merge passes    %zu\n", stats.merge_passes);
+  std::printf("bytes read      %.1f MiB\n", stats.bytes_read / double(1 << 20));
+  std::printf("bytes written   %.1f MiB\n", stats.bytes_written / double(1 << 20));
+  std::printf("time            %.2f s (%.1f MiB/s)\n", secs, stats.records * 8.0 / (1 << 20) / secs);
+  std::printf("peak RSS        %ld KiB before sort, %ld KiB after\n", rss_before, peak_rss_kb());
+}
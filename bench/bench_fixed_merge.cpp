@@ -0,0 +1,59 @@
+// Unrolled fixed-K merges vs. the generic loser tree and heap for small K.
+//
+// usage: bench_fixed_merge [total_elements]
+
+#include <cstdio>
+#include <vector>
+
+#include "bench_util.hpp"
+#include "nway/fixed_merge.hpp"
+#include "nway/heap_merge.hpp"
+#include "nway/loser_tree.hpp"
+
+namespace {
+
+struct Item {
+  std::uint64_t key;
+  std::uint64_t value;
+  bool operator==(const Item&) const = default;
+};
+
+template <class T, class Compare>
+void bench_k(const char* type, std::size_t k, const std::vector<std::vector<T>>& runs,
+             Compare comp) {
+  std::size_t n = 0;
+  for (const auto& r : runs) n += r.size();
+  std::vector<T> expected(n), out(n);
+
+  bench::Timer t_heap;
+  nway::heap_merge(runs, expected.begin(), comp);
+  const double s_heap = t_heap.seconds();
+  bench::Timer t_tree;
+  nway::loser_tree_merge(runs, out.begin(), comp);
+  const double s_tree = t_tree.seconds();
+  bench::check(out == expected, "loser tree differs");
+  bench::Timer t_fixed;
+  nway::fixed_merge(runs, out.begin(), comp);
+  const double s_fixed = t_fixed.seconds();
+  bench::check(out == expected, "fixed merge differs");
+
+  std::printf("%-7s %3zu %12.2f %12.2f %12.2f %9.2fx\n", type, k, s_heap * 1e9 / n,
+              s_tree * 1e9 / n, s_fixed * 1e9 / n, s_tree / s_fixed);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t total = bench::arg_size(argc, argv, 1, std::size_t(1) << 23);
+  std::printf("ns per element\n%-7s %3s %12s %12s %12s %10s\n", "type", "K", "heap", "loser-tree",
+              "fixed-K", "vs tree");
+  for (std::size_t k = 2; k <= nway::kFixedMaxK; ++k) {
+    const auto keys = bench::random_runs(k, total / k, k);
+    bench_k("uint64", k, keys, std::less<>());
+
+    std::vector<std::vector<Item>> items(k);
+    for (std::size_t i = 0; i < k; ++i)
+      for (auto key : keys[i]) items[i].push_back({key, i});
+    bench_k("item", k, items, [](const Item& a, const Item& b) { return a.key < b.key; });
+  }
+}
@@ -0,0 +1,90 @@
+// Forecasting prefetch vs. double buffering under the same memory budget.
+//
+// usage: bench_forecast [memory_limit_mb] [buffer_kb] [records_per_run] [temp_dir]
+//
+// The fan-in each reader affords within the budget is computed as the
+// external sort would; that many run files are then merged cold (evicted from
+// the page cache) with each reader.
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <vector>
+
+#include "bench_util.hpp"
+#include "nway/async_run.hpp"
+#include "nway/detail/file.hpp"
+#include "nway/external_sort.hpp"
+#include "nway/forecast_run.hpp"
+#include "nway/run_file.hpp"
+
+namespace {
+
+using Key = std::uint64_t;
+
+void evict(const std::filesystem::path& p) {
+  nway::detail::File f(p, O_RDONLY);
+  ::fdatasync(f.fd());
+  ::posix_fadvise(f.fd(), 0, 0, POSIX_FADV_DONTNEED);
+}
+
+template <class Set>
+double merge(Set& set, const std::filesystem::path& out) {
+  bench::Timer t;
+  nway::RunWriter<Key> w(out, std::size_t(1) << 20);
+  std::less<> comp;
+  nway::detail::merge_cursors(set.cursors(), w, comp);
+  w.finish();
+  return t.seconds();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  nway::ExternalSortOptions opts;
+  opts.memory_limit = bench::arg_size(argc, argv, 1, 64) << 20;
+  opts.read_buffer = bench::arg_size(argc, argv, 2, 256) << 10;
+  const std::size_t per_run = bench::arg_size(argc, argv, 3, std::size_t(1) << 16);
+  nway::TempDir dir(argc > 4 ? argv[4] : "");
+
+  opts.run_io = nway::RunIo::async;
+  const std::size_t k_double = nway::external_fan_in<Key>(opts);
+  opts.run_io = nway::RunIo::forecast;
+  const std::size_t k_forecast = nway::external_fan_in<Key>(opts);
+
+  std::vector<std::filesystem::path> runs;
+  for (const auto& run : bench::random_runs(k_forecast, per_run)) {
+    runs.push_back(dir.next_file());
+    nway::RunWriter<Key> w(runs.back(), std::size_t(1) << 20);
+    w.write(run.data(), run.size());
+    w.finish();
+  }
+  const auto out = dir.path() / "merged.bin";
+  const double mib_per_run = per_run * 8.0 / (1 << 20);
+
+  std::printf("memory %zu MiB, buffer %zu KiB\n", opts.memory_limit >> 20, opts.read_buffer >> 10);
+  std::printf("%-16s %8s %10s %10s %12s\n", "reader", "fan-in", "buffers", "seconds", "MiB/s");
+
+  {
+    std::vector<std::filesystem::path> group(runs.begin(), runs.begin() + k_double);
+    for (const auto& p : group) evict(p);
+    nway::AsyncRunSet<Key> set(group, opts.read_buffer);
+    const double secs = merge(set, out);
+    std::printf("%-16s %8zu %10zu %10.3f %12.1f\n", "double-buffer", k_double, 2 * k_double, secs,
+                k_double * mib_per_run / secs);
+  }
+  {
+    for (const auto& p : runs) evict(p);
+    nway::ForecastRunSet<Key> set(runs, opts.read_buffer);
+    const double secs = merge(set, out);
+    const auto& st = set.stats();
+    const std::size_t pool = nway::ForecastRunSet<Key>::default_prefetch_buffers(k_forecast);
+    std::printf("%-16s %8zu %10zu %10.3f %12.1f\n", "forecast", k_forecast, k_forecast + pool, secs,
+                k_forecast * mib_per_run / secs);
+    std::printf("forecast blocks: %zu hits, %zu stalls, %zu misses\n", st.hits, st.stalls,
+                st.misses);
+  }
+  std::printf("fan-in gain at equal memory: %.2fx\n", double(k_forecast) / k_double);
+}
@@ -0,0 +1,70 @@
+// Galloping merge vs. the plain loser tree as the inputs go from disjoint
+// (time-partitioned, overlap 0) to fully interleaved (overlap 1). Run i draws
+// its keys from [i (1 - overlap) W, i (1 - overlap) W + W). The concat column
+// is a plain copy of the runs back to back: the floor for disjoint inputs.
+//
+// usage: bench_gallop_merge [K] [total_elements]
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "bench_util.hpp"
+#include "nway/gallop_merge.hpp"
+#include "nway/loser_tree.hpp"
+#include "nway/merge.hpp"
+
+namespace {
+
+std::vector<std::vector<std::uint64_t>> overlapping_runs(std::size_t k, std::size_t n,
+                                                         double overlap) {
+  constexpr double kWidth = double(std::uint64_t(1) << 40);
+  std::mt19937_64 rng(7);
+  std::uniform_real_distribution<double> unit(0.0, 1.0);
+  std::vector<std::vector<std::uint64_t>> runs(k);
+  for (std::size_t i = 0; i < k; ++i) {
+    const double base = double(i) * (1.0 - overlap) * kWidth;
+    runs[i].resize(n);
+    for (auto& x : runs[i]) x = static_cast<std::uint64_t>(base + unit(rng) * kWidth);
+    std::sort(runs[i].begin(), runs[i].end());
+  }
+  return runs;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t k = bench::arg_size(argc, argv, 1, 16);
+  const std::size_t total = bench::arg_size(argc, argv, 2, std::size_t(1) << 23);
+  const std::size_t n = total / k;
+  std::printf("K=%zu, %zu elements, ns per element\n", k, n * k);
+  std::printf("%8s %10s %12s %10s %10s %9s\n", "overlap", "concat", "loser-tree", "gallop",
+              "merge()", "speedup");
+  for (double overlap : {0.0, 0.001, 0.01, 0.1, 0.25, 0.5, 0.75, 1.0}) {
+    const auto runs = overlapping_runs(k, n, overlap);
+    std::vector<std::uint64_t> expected(n * k), out(n * k);
+
+    bench::Timer t_concat;
+    auto it = out.begin();
+    for (const auto& run : runs) it = std::copy(run.begin(), run.end(), it);
+    const double s_concat = t_concat.seconds();
+    bench::do_not_optimize(out.data());
+
+    bench::Timer t_tree;
+    nway::loser_tree_merge(runs, expected.begin());
+    const double s_tree = t_tree.seconds();
+    bench::Timer t_gallop;
+    nway::galloping_merge(runs, out.begin());
+    const double s_gallop = t_gallop.seconds();
+    bench::check(out == expected, "galloping merge differs");
+    bench::Timer t_merge;
+    nway::merge(runs, out.begin());
+    const double s_merge = t_merge.seconds();
+    bench::check(out == expected, "merge() differs");
+
+    const double per = 1e9 / double(n * k);
+    std::printf("%8.3f %10.2f %12.2f %10.2f %10.2f %8.2fx\n", overlap, s_concat * per,
+                s_tree * per, s_gallop * per, s_merge * per, s_tree / s_gallop);
+  }
+}
@@ -0,0 +1,74 @@
+// Whole-record merge vs. key-only merge across record sizes.
+//
+// usage: bench_indexed_merge [K] [total_elements]
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "bench_util.hpp"
+#include "nway/indexed_merge.hpp"
+#include "nway/loser_tree.hpp"
+
+namespace {
+
+template <std::size_t Bytes>
+struct Record {
+  std::uint64_t key;
+  unsigned char payload[Bytes - sizeof(std::uint64_t)];
+
+  bool operator==(const Record& o) const { return std::memcmp(this, &o, sizeof(Record)) == 0; }
+};
+
+template <std::size_t Bytes>
+void bench_size(std::size_t k, std::size_t total) {
+  using R = Record<Bytes>;
+  const std::size_t per_run = total / k;
+  const auto keys = bench::random_runs(k, per_run, Bytes);
+  std::vector<std::vector<R>> runs(k);
+  for (std::size_t i = 0; i < k; ++i) {
+    runs[i].resize(per_run);
+    for (std::size_t j = 0; j < per_run; ++j) {
+      runs[i][j].key = keys[i][j];
+      std::memset(runs[i][j].payload, int(j), sizeof(runs[i][j].payload));
+    }
+  }
+  const std::size_t n = k * per_run;
+  const auto key = [](const R& r) { return r.key; };
+  std::vector<R> whole(n), indexed(n), gathered(n);
+
+  bench::Timer t_whole;
+  nway::loser_tree_merge(runs, whole.begin(), [](const R& a, const R& b) { return a.key < b.key; });
+  const double s_whole = t_whole.seconds();
+
+  bench::Timer t_indexed;
+  nway::indexed_merge(runs, indexed.begin(), key);
+  const double s_indexed = t_indexed.seconds();
+
+  bench::Timer t_perm;
+  const auto perm = nway::merge_permutation(runs, key);
+  const double s_perm = t_perm.seconds();
+  bench::Timer t_gather;
+  nway::gather(runs, perm, gathered.begin());
+  const double s_gather = t_gather.seconds();
+
+  bench::check(whole == indexed && whole == gathered, "merge variants disagree");
+  std::printf("%6zu %12.2f %12.2f %12.2f %12.2f %8.2fx\n", Bytes, s_whole * 1e9 / n,
+              s_indexed * 1e9 / n, s_perm * 1e9 / n, s_gather * 1e9 / n, s_whole / s_indexed);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t k = bench::arg_size(argc, argv, 1, 256);
+  const std::size_t total = bench::arg_size(argc, argv, 2, std::size_t(1) << 21);
+  std::printf("K=%zu, ~%zu records; ns per record\n", k, total);
+  std::printf("%6s %12s %12s %12s %12s %9s\n", "bytes", "whole", "indexed", "perm-only", "gather",
+              "speedup");
+  bench_size<16>(k, total);
+  bench_size<32>(k, total);
+  bench_size<64>(k, total);
+  bench_size<128>(k, total);
+  bench_size<256>(k, total);
+}
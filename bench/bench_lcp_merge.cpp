@@ -0,0 +1,111 @@
+// String merges on corpora with long shared prefixes: the loser tree with
+// plain string comparisons (each one rescans the common prefix) against the
+// LCP-aware loser tree of lcp_merge.hpp, which resumes each comparison at
+// the first differing character. lcp_merge runs twice: computing each run's
+// LCPs on the fly, and given LCP arrays as a string sorter would produce.
+// Corpora: synthetic URLs, synthetic file paths, and optionally the lines of
+// a file (e.g. `find / > paths.txt`).
+//
+// usage: bench_lcp_merge [K] [strings] [corpus_file]
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "bench_util.hpp"
+#include "nway/lcp_merge.hpp"
+#include "nway/loser_tree.hpp"
+
+namespace {
+
+const char* const kWords[] = {"api",     "v1",     "v2",      "users",  "items",   "search",
+                              "static",  "images", "docs",    "blog",   "2024",    "2025",
+                              "product", "detail", "category", "media", "assets",  "en-us",
+                              "account", "orders", "checkout", "help",  "reviews", "latest"};
+
+std::string word(std::mt19937_64& rng) { return kWords[rng() % std::size(kWords)]; }
+
+std::vector<std::string> urls(std::size_t n, std::mt19937_64& rng) {
+  std::vector<std::string> out(n);
+  for (auto& s : out) {
+    s = "https://www." + std::string(rng() % 4 == 0 ? "shop" : "news") + "." +
+        std::to_string(rng() % 64) + ".example.com/";
+    for (std::size_t d = 1 + rng() % 5; d > 0; --d) s += word(rng) + "/";
+    s += "page?id=" + std::to_string(rng() % 1000000);
+  }
+  return out;
+}
+
+std::vector<std::string> paths(std::size_t n, std::mt19937_64& rng) {
+  std::vector<std::string> out(n);
+  for (auto& s : out) {
+    s = "/home/user" + std::to_string(rng() % 8) + "/projects/project-" +
+        std::to_string(rng() % 16) + "/src";
+    for (std::size_t d = 1 + rng() % 6; d > 0; --d) s += "/module_" + std::to_string(rng() % 12);
+    s += "/file_" + std::to_string(rng() % 4096) + (rng() % 2 ? ".cpp" : ".hpp");
+  }
+  return out;
+}
+
+void run(const char* name, const std::vector<std::string>& corpus, std::size_t k) {
+  // Deal the strings round-robin into K runs and sort each run.
+  std::vector<std::vector<std::string_view>> runs(k);
+  for (std::size_t i = 0; i < corpus.size(); ++i) runs[i % k].push_back(corpus[i]);
+  std::vector<std::vector<std::size_t>> lcps(k);
+  for (std::size_t i = 0; i < k; ++i) {
+    std::sort(runs[i].begin(), runs[i].end());
+    lcps[i].assign(runs[i].size(), 0);
+    for (std::size_t j = 1; j < runs[i].size(); ++j)
+      lcps[i][j] = nway::detail::common_prefix(runs[i][j - 1], runs[i][j], 0);
+  }
+
+  const std::size_t n = corpus.size();
+  std::vector<std::string_view> expected(n), out(n);
+  std::vector<std::size_t> out_lcp(n);
+  bench::Timer t_plain;
+  nway::loser_tree_merge(runs, expected.begin());
+  const double s_plain = t_plain.seconds();
+  bench::Timer t_lcp;
+  nway::lcp_merge(runs, out.begin(), out_lcp.data());
+  const double s_lcp = t_lcp.seconds();
+  bench::check(out == expected, "lcp_merge order differs");
+  bench::Timer t_given;
+  nway::lcp_merge(runs, lcps, out.begin());
+  const double s_given = t_given.seconds();
+  bench::check(out == expected, "lcp_merge with LCP arrays differs");
+
+  double length = 0, lcp = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    length += double(out[i].size());
+    lcp += double(out_lcp[i]);
+  }
+  const auto ns = [&](double s) { return 1e9 * s / double(n); };
+  std::printf("%-8s %9zu %6zu %7.1f %7.1f %10.1f %10.1f %10.1f %7.2f %7.2f\n", name, n, k,
+              length / double(n), lcp / double(n), ns(s_plain), ns(s_lcp), ns(s_given),
+              s_plain / s_lcp, s_plain / s_given);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t k = std::max<std::size_t>(1, bench::arg_size(argc, argv, 1, 64));
+  const std::size_t n = bench::arg_size(argc, argv, 2, std::size_t(1) << 21);
+
+  std::printf("ns per string; speedup over the plain loser tree\n");
+  std::printf("%-8s %9s %6s %7s %7s %10s %10s %10s %7s %7s\n", "corpus", "strings", "K", "length",
+              "lcp", "loser", "lcp_merge", "+lcp in", "x", "x in");
+  std::mt19937_64 rng(17);
+  run("urls", urls(n, rng), k);
+  run("paths", paths(n, rng), k);
+  if (argc > 3) {
+    std::vector<std::string> lines;
+    std::ifstream in(argv[3]);
+    for (std::string line; std::getline(in, line) && lines.size() < n;) lines.push_back(line);
+    std::shuffle(lines.begin(), lines.end(), rng);
+    run("file", lines, k);
+  }
+}
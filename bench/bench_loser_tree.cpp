@@ -0,0 +1,37 @@
+// Loser tree vs. binary heap merge across fan-in K = 2 .. 65536.
+//
+// usage: bench_loser_tree [total_elements]
+
+#include <cstdio>
+#include <vector>
+
+#include "bench_util.hpp"
+#include "nway/heap_merge.hpp"
+#include "nway/loser_tree.hpp"
+
+int main(int argc, char** argv) {
+  const std::size_t total = bench::arg_size(argc, argv, 1, std::size_t(1) << 22);
+
+  std::printf("%8s %10s | %12s %10s | %12s %10s | %7s\n", "K", "elements", "heap ns/el",
+              "heap cmp", "tree ns/el", "tree cmp", "speedup");
+  for (std::size_t k = 2; k <= 65536; k *= 2) {
+    const std::size_t per_run = std::max<std::size_t>(total / k, 16);
+    const auto runs = bench::random_runs(k, per_run, k);
+    const std::size_t n = k * per_run;
+    std::vector<std::uint64_t> out_heap(n), out_tree(n);
+
+    std::uint64_t heap_cmp = 0, tree_cmp = 0;
+    bench::Timer t_heap;
+    nway::heap_merge(runs, out_heap.begin(), bench::CountingLess{&heap_cmp});
+    const double heap_s = t_heap.seconds();
+
+    bench::Timer t_tree;
+    nway::loser_tree_merge(runs, out_tree.begin(), bench::CountingLess{&tree_cmp});
+    const double tree_s = t_tree.seconds();
+
+    bench::check(out_heap == out_tree, "heap and loser tree disagree");
+    bench::check(std::is_sorted(out_tree.begin(), out_tree.end()), "output not sorted");
+    std::printf("%8zu %10zu | %12.2f %10.2f | %12.2f %10.2f | %6.2fx\n", k, n, heap_s * 1e9 / n,
+                double(heap_cmp) / n, tree_s * 1e9 / n, double(tree_cmp) / n, heap_s / tree_s);
+  }
+}
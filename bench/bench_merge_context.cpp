@@ -0,0 +1,86 @@
+// Latency of many small merges (query-path shape: K lists of ~100 elements)
+// through a reused MergeContext vs. per-call allocating entry points. That a
+// warm context allocates nothing is checked by tests/merge_context_test.
+//
+// usage: bench_merge_context [K] [elements_per_list] [calls]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "bench_util.hpp"
+#include "nway/merge.hpp"
+#include "nway/merge_context.hpp"
+
+namespace {
+
+struct Latency {
+  double p50, p99, p999;
+};
+
+template <class Fn>
+Latency measure(std::size_t calls, Fn&& fn) {
+  std::vector<double> ns(calls);
+  for (std::size_t c = 0; c < calls; ++c) {
+    const auto t0 = std::chrono::steady_clock::now();
+    fn(c);
+    const auto t1 = std::chrono::steady_clock::now();
+    ns[c] = std::chrono::duration<double, std::nano>(t1 - t0).count();
+  }
+  std::sort(ns.begin(), ns.end());
+  return {ns[calls / 2], ns[calls * 99 / 100], ns[calls * 999 / 1000]};
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t k = bench::arg_size(argc, argv, 1, 16);
+  const std::size_t per_list = bench::arg_size(argc, argv, 2, 100);
+  const std::size_t calls = bench::arg_size(argc, argv, 3, 200000);
+
+  // A pool of distinct queries, cycled through so inputs are not all hot.
+  constexpr std::size_t kQueries = 256;
+  std::vector<std::vector<std::vector<std::uint64_t>>> queries;
+  for (std::size_t q = 0; q < kQueries; ++q) queries.push_back(bench::random_runs(k, per_list, q));
+  const std::size_t total = k * per_list;
+  std::vector<std::uint64_t> out(total);
+
+  nway::MergeContext<std::uint64_t> ctx;
+  for (const auto& q : queries) ctx.merge(q);  // warm up to peak size
+
+  std::printf("K=%zu, %zu elements per list, %zu calls, latency in ns\n", k, per_list, calls);
+  std::printf("%-22s %10s %10s %10s\n", "engine", "p50", "p99", "p99.9");
+  const auto report = [&](const char* name, Latency l) {
+    std::printf("%-22s %10.0f %10.0f %10.0f\n", name, l.p50, l.p99, l.p999);
+  };
+
+  std::uint64_t sink = 0;
+  Latency l = measure(calls, [&](std::size_t c) {
+    auto v = nway::merge_to_vector(queries[c % kQueries]);
+    sink += v[total / 2];
+  });
+  report("merge_to_vector", l);
+
+  l = measure(calls, [&](std::size_t c) {
+    nway::loser_tree_merge(queries[c % kQueries], out.begin());
+    sink += out[total / 2];
+  });
+  report("loser_tree_merge", l);
+
+  l = measure(calls, [&](std::size_t c) {
+    ctx.merge(queries[c % kQueries], out.begin());
+    sink += out[total / 2];
+  });
+  report("MergeContext (out)", l);
+
+  l = measure(calls, [&](std::size_t c) {
+    auto merged = ctx.merge(queries[c % kQueries]);
+    sink += merged[total / 2];
+  });
+  report("MergeContext (span)", l);
+
+  bench::check(std::ranges::equal(ctx.merge(queries[0]), nway::merge_to_vector(queries[0])),
+               "MergeContext result differs");
+  bench::do_not_optimize(sink);
+}
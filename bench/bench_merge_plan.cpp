@@ -0,0 +1,104 @@
+// Merge-pass planning for runs of unequal size: arrival order (level by
+// level) vs. the Huffman plan. Run sizes are log-uniform between the
+// smallest and the largest and arrive shuffled. First the planners alone on
+// a production-like spread (4 MiB .. 40 GiB), then real merges of run files
+// through external_merge(), with planned and actual bytes read per pass.
+//
+// usage: bench_merge_plan [runs] [smallest_run_kb] [largest_run_mb] [memory_limit_mb]
+//                         [read_buffer_kb] [temp_dir]
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "bench_util.hpp"
+#include "nway/external_sort.hpp"
+#include "nway/merge_plan.hpp"
+#include "nway/run_file.hpp"
+
+namespace {
+
+std::vector<std::uint64_t> run_sizes(std::size_t runs, double smallest, double largest,
+                                     std::uint64_t seed) {
+  std::mt19937_64 rng(seed);
+  std::uniform_real_distribution<double> exponent(std::log(smallest), std::log(largest));
+  std::vector<std::uint64_t> sizes(runs);
+  for (auto& s : sizes) s = static_cast<std::uint64_t>(std::exp(exponent(rng)));
+  return sizes;
+}
+
+double gib(std::uint64_t bytes) { return bytes / double(std::uint64_t(1) << 30); }
+double mib(std::uint64_t bytes) { return bytes / double(1 << 20); }
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t runs = bench::arg_size(argc, argv, 1, 64);
+  const std::size_t smallest_kb = bench::arg_size(argc, argv, 2, 64);
+  const std::size_t largest_mb = bench::arg_size(argc, argv, 3, 64);
+  nway::ExternalSortOptions opts;
+  opts.memory_limit = bench::arg_size(argc, argv, 4, 4) << 20;
+  opts.read_buffer = bench::arg_size(argc, argv, 5, 256) << 10;
+  opts.write_buffer = opts.read_buffer;
+  if (argc > 6) opts.temp_dir = argv[6];
+  const std::size_t fan_in = nway::external_fan_in<std::uint64_t>(opts);
+
+  {
+    const auto sizes = run_sizes(200, 4.0 * (1 << 20), 40.0 * (std::uint64_t(1) << 30), 1);
+    std::uint64_t total = 0;
+    for (auto s : sizes) total += s;
+    std::printf("planner only: 200 runs of 4 MiB .. 40 GiB (%.0f GiB), fan-in 16\n", gib(total));
+    for (bool huffman : {false, true}) {
+      const auto plan = huffman ? nway::plan_huffman_merges(sizes, 16)
+                                : nway::plan_arrival_merges(sizes, 16);
+      std::printf("  %-8s %zu merges, %zu passes, %.0f GiB read (%.2fx the data)\n",
+                  huffman ? "huffman" : "arrival", plan.steps.size(), plan.passes(),
+                  gib(plan.total_bytes()), double(plan.total_bytes()) / double(total));
+    }
+  }
+
+  nway::TempDir dir(opts.temp_dir);
+  const auto sizes = run_sizes(runs, smallest_kb * 1024.0, largest_mb * 1048576.0, 2);
+  std::vector<std::filesystem::path> paths;
+  std::uint64_t total = 0;
+  std::mt19937_64 rng(3);
+  for (std::uint64_t bytes : sizes) {
+    std::vector<std::uint64_t> keys(bytes / sizeof(std::uint64_t));
+    for (auto& k : keys) k = rng();
+    std::sort(keys.begin(), keys.end());
+    paths.push_back(dir.path() / ("in-" + std::to_string(paths.size()) + ".run"));
+    nway::RunWriter<std::uint64_t> w(paths.back(), std::size_t(1) << 20);
+    w.write(keys.data(), keys.size());
+    w.finish();
+    total += keys.size() * sizeof(std::uint64_t);
+  }
+  std::printf("\nmerging %zu runs of %zu KiB .. %zu MiB (%.1f MiB), fan-in %zu\n", runs,
+              smallest_kb, largest_mb, mib(total), fan_in);
+
+  for (auto schedule : {nway::MergeSchedule::arrival, nway::MergeSchedule::huffman}) {
+    const bool huffman = schedule == nway::MergeSchedule::huffman;
+    const auto output = dir.path() / (huffman ? "huffman.bin" : "arrival.bin");
+    opts.merge_schedule = schedule;
+    bench::Timer t;
+    const auto stats = nway::external_merge<std::uint64_t>(paths, output, opts);
+    const double secs = t.seconds();
+
+    nway::RunReader<std::uint64_t> check(output, std::size_t(1) << 20);
+    std::uint64_t n = 0, prev = 0;
+    for (; !check.empty(); check.pop(), ++n) {
+      bench::check(check.front() >= prev, "output not sorted");
+      prev = check.front();
+    }
+    bench::check(n * sizeof(std::uint64_t) == total, "output lost records");
+    std::filesystem::remove(output);
+
+    std::printf("  %-8s %.2f s, %.1f MiB read (%.2fx the data)\n",
+                huffman ? "huffman" : "arrival", secs,
+                mib(stats.bytes_read), double(stats.bytes_read) / double(total));
+    for (std::size_t p = 0; p < stats.merge_passes; ++p)
+      std::printf("    pass %zu  planned %8.1f MiB  read %8.1f MiB\n", p + 1,
+                  mib(stats.predicted_pass_bytes[p]), mib(stats.pass_bytes_read[p]));
+  }
+}
@@ -0,0 +1,116 @@
+// Composite sort keys (int32 desc, string asc, double asc) merged three
+// ways: a chained lambda comparator over the records, and normalized keys
+// (normalized_key.hpp) compared by one memcmp or by their 64-bit prefix with
+// a memcmp fallback. All three merge handles to the records (pointers or
+// NormalizedKeys), so the difference is the comparison. Encoding is timed
+// separately: it is paid once per record, the comparisons about log2(K)
+// times.
+//
+// usage: bench_normalized_keys [K] [records_per_run] [distinct_ints]
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "bench_util.hpp"
+#include "nway/merge.hpp"
+#include "nway/normalized_key.hpp"
+
+namespace {
+
+struct Record {
+  std::int32_t group;
+  std::string name;
+  double score;
+};
+
+bool record_less(const Record& a, const Record& b) {
+  if (a.group != b.group) return a.group > b.group;
+  if (a.name != b.name) return a.name < b.name;
+  return a.score < b.score;
+}
+
+void encode(nway::KeyEncoder& e, const Record& r) {
+  e.add(r.group, nway::KeyOrder::desc).add(r.name).add(r.score);
+}
+
+std::string random_name(std::mt19937_64& rng) {
+  std::string s(3 + rng() % 10, 'a');
+  for (auto& c : s) c = static_cast<char>('a' + rng() % 26);
+  return s;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t k = bench::arg_size(argc, argv, 1, 64);
+  const std::size_t n = bench::arg_size(argc, argv, 2, 1 << 15);
+  const std::size_t groups = std::max<std::size_t>(1, bench::arg_size(argc, argv, 3, 16));
+
+  std::mt19937_64 rng(7);
+  std::vector<std::vector<Record>> runs(k);
+  for (auto& run : runs) {
+    run.resize(n);
+    for (auto& r : run)
+      r = {static_cast<std::int32_t>(rng() % groups), random_name(rng),
+           std::uniform_real_distribution<double>(-1e3, 1e3)(rng)};
+    std::sort(run.begin(), run.end(), record_less);
+  }
+  const std::size_t total = k * n;
+
+  // Lambda baseline: merge pointers to the records.
+  std::vector<std::vector<const Record*>> pointers(k);
+  std::vector<const Record*> rows;
+  rows.reserve(total);
+  for (std::size_t i = 0; i < k; ++i)
+    for (const auto& r : runs[i]) {
+      pointers[i].push_back(&r);
+      rows.push_back(&r);
+    }
+  std::vector<const Record*> by_lambda(total);
+  bench::Timer t_lambda;
+  nway::merge(pointers, by_lambda.begin(),
+              [](const Record* a, const Record* b) { return record_less(*a, *b); });
+  const double s_lambda = t_lambda.seconds();
+
+  bench::Timer t_encode;
+  std::vector<nway::NormalizedRun> normalized;
+  normalized.reserve(k);
+  std::size_t bytes = 0;
+  for (std::size_t i = 0; i < k; ++i) {
+    normalized.emplace_back(runs[i], encode, static_cast<std::uint32_t>(i * n));
+    bytes += normalized.back().encoded_bytes();
+  }
+  const double s_encode = t_encode.seconds();
+  std::vector<std::span<const nway::NormalizedKey>> keys;
+  for (const auto& run : normalized) keys.push_back(run.keys());
+
+  std::vector<nway::NormalizedKey> out(total);
+  const auto run_keys = [&](auto comp) {
+    bench::Timer t;
+    nway::merge(keys, out.begin(), comp);
+    const double s = t.seconds();
+    for (std::size_t i = 0; i < total; ++i)
+      bench::check(rows[out[i].row] == by_lambda[i], "normalized order differs from the lambda");
+    return s;
+  };
+  const double s_memcmp = run_keys(nway::NormalizedMemcmpLess{});
+  const double s_prefix = run_keys(nway::NormalizedPrefixLess{});
+
+  std::size_t prefix_ties = 0;
+  for (std::size_t i = 1; i < total; ++i) prefix_ties += out[i].prefix == out[i - 1].prefix;
+
+  const auto ns = [&](double s) { return 1e9 * s / double(total); };
+  std::printf("K=%zu, %zu records, %zu distinct ints, %.1f key bytes/record, "
+              "%.1f%% neighbours tie on the prefix\n",
+              k, total, groups, double(bytes) / double(total),
+              100.0 * double(prefix_ties) / double(total));
+  std::printf("%-24s %8s %8s\n", "comparator", "ns/rec", "speedup");
+  std::printf("%-24s %8.1f %8.2f\n", "lambda (3 columns)", ns(s_lambda), 1.0);
+  std::printf("%-24s %8.1f %8.2f\n", "normalized memcmp", ns(s_memcmp), s_lambda / s_memcmp);
+  std::printf("%-24s %8.1f %8.2f\n", "normalized prefix", ns(s_prefix), s_lambda / s_prefix);
+  std::printf("%-24s %8.1f          (once per record)\n", "encoding", ns(s_encode));
+}
@@ -0,0 +1,52 @@
+// NUMA placement of the parallel merge: OS default vs. node-local (threads
+// pinned by input residency, output first-touched by its writer) vs. output
+// interleaved over all nodes. Runs are spread round-robin over the nodes.
+// Each timing uses a fresh, untouched output buffer so first touch matters.
+// On a single-node host, or without libnuma, all three do the same work.
+//
+// usage: bench_numa_merge [K] [elements_per_run] [threads]
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "bench_util.hpp"
+#include "nway/loser_tree.hpp"
+#include "nway/numa_merge.hpp"
+
+int main(int argc, char** argv) {
+  const std::size_t k = bench::arg_size(argc, argv, 1, 64);
+  const std::size_t per_run = bench::arg_size(argc, argv, 2, 1 << 17);
+  const std::size_t threads =
+      bench::arg_size(argc, argv, 3, std::max(1u, std::thread::hardware_concurrency()));
+  auto runs = bench::random_runs(k, per_run);
+  const int nodes = nway::numa::nodes();
+  for (std::size_t i = 0; i < k; ++i)
+    nway::numa::place_on_node(runs[i].data(), runs[i].size() * sizeof(std::uint64_t),
+                              int(i % nodes));
+  const std::size_t n = k * per_run;
+
+  std::vector<std::uint64_t> expected(n);
+  nway::loser_tree_merge(runs, expected.begin());
+
+  std::printf("K=%zu, %zu elements, %zu threads, libnuma %s, %d node(s)\n", k, n, threads,
+              nway::numa::available() ? "on" : "off", nodes);
+  const auto per_node = nway::detail::input_bytes_per_node(runs);
+  std::printf("input MiB per node:");
+  for (double b : per_node) std::printf(" %.1f", b / (1 << 20));
+  std::printf("\n%-12s %12s %12s\n", "placement", "ms", "Melem/s");
+  for (auto placement : {nway::NumaPlacement::none, nway::NumaPlacement::local,
+                         nway::NumaPlacement::interleave}) {
+    for (int rep = 0; rep < 3; ++rep) {
+      std::unique_ptr<std::uint64_t[]> out(new std::uint64_t[n]);
+      bench::Timer t;
+      nway::numa_parallel_merge(runs, out.get(), threads, placement);
+      const double secs = t.seconds();
+      bench::check(std::equal(expected.begin(), expected.end(), out.get()),
+                   "NUMA merge differs from sequential merge");
+      std::printf("%-12s %12.2f %12.1f\n", nway::to_string(placement), secs * 1e3, n / secs / 1e6);
+    }
+  }
+}
@@ -0,0 +1,99 @@
+// Packed (delta + frame-of-reference bit-packed) spill runs vs raw ones.
+// First the codec alone: compression ratio of sorted runs of random keys and
+// decode throughput of the scalar and AVX2 block decoders. Then external
+// sorts of random uint64 keys with raw and packed spills: bytes moved and
+// end-to-end time.
+//
+// usage: bench_packed_runs [records] [memory_limit_mb] [read_buffer_kb] [temp_dir]
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "bench_util.hpp"
+#include "nway/external_sort.hpp"
+#include "nway/packed_run.hpp"
+#include "nway/run_file.hpp"
+
+namespace {
+
+double mib(std::uint64_t bytes) { return bytes / double(1 << 20); }
+
+template <class T>
+void codec(const char* name, std::size_t n, const std::filesystem::path& path) {
+  std::vector<T> keys(n);
+  std::mt19937_64 rng(11);
+  for (auto& k : keys) k = static_cast<T>(rng());
+  std::sort(keys.begin(), keys.end());
+
+  bench::Timer enc;
+  nway::PackedRunWriter<T> w(path, std::size_t(1) << 20);
+  w.write(keys.data(), n);
+  w.finish();
+  const double enc_secs = enc.seconds();
+  const double raw = double(n * sizeof(T));
+  std::printf("%-8s %zu keys: %.2f bits/key (%.2fx smaller), encode %.0f MiB/s\n", name, n,
+              8.0 * w.bytes_written() / double(n), raw / double(w.bytes_written()),
+              raw / (1 << 20) / enc_secs);
+  for (auto level : {nway::SimdLevel::scalar, nway::SimdLevel::avx2}) {
+    if (level > nway::simd_level()) continue;
+    bench::Timer dec;
+    nway::PackedRunReader<T> r(path, std::size_t(1) << 20, level);
+    std::size_t i = 0;
+    for (; !r.empty(); r.pop(), ++i) bench::check(r.front() == keys[i], "decode mismatch");
+    bench::check(i == n, "decode lost keys");
+    std::printf("  decode %-6s %7.0f MiB/s of raw keys (reader loop included)\n",
+                nway::to_string(level), raw / (1 << 20) / dec.seconds());
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t records = bench::arg_size(argc, argv, 1, std::size_t(1) << 24);
+  nway::ExternalSortOptions base;
+  base.memory_limit = bench::arg_size(argc, argv, 2, 16) << 20;
+  base.read_buffer = bench::arg_size(argc, argv, 3, 256) << 10;
+  base.write_buffer = base.read_buffer;
+  if (argc > 4) base.temp_dir = argv[4];
+
+  nway::TempDir dir(base.temp_dir);
+  codec<std::uint32_t>("uint32", std::size_t(1) << 22, dir.path() / "codec32.bin");
+  codec<std::uint64_t>("uint64", std::size_t(1) << 22, dir.path() / "codec64.bin");
+
+  const auto input = dir.path() / "input.bin";
+  {
+    nway::RunWriter<std::uint64_t> w(input, std::size_t(1) << 20);
+    std::mt19937_64 rng(1);
+    for (std::size_t i = 0; i < records; ++i) w.push(rng());
+    w.finish();
+  }
+  std::printf("\nexternal sort of %zu uint64 (%.0f MiB), %zu MiB budget\n", records,
+              mib(records * 8), base.memory_limit >> 20);
+  std::printf("%-7s %6s %6s %6s %12s %12s %8s %8s\n", "spill", "runs", "fan-in", "passes",
+              "read", "written", "phase 1", "total");
+  for (auto format : {nway::SpillFormat::raw, nway::SpillFormat::packed}) {
+    nway::ExternalSortOptions opts = base;
+    opts.spill_format = format;
+    const bool packed = format == nway::SpillFormat::packed;
+    const auto output = dir.path() / (packed ? "packed.bin" : "raw.bin");
+    bench::Timer t;
+    const auto stats = nway::external_sort<std::uint64_t>(input, output, opts);
+    const double secs = t.seconds();
+
+    nway::RunReader<std::uint64_t> check(output, std::size_t(1) << 20);
+    std::uint64_t n = 0, prev = 0;
+    for (; !check.empty(); check.pop(), ++n) {
+      bench::check(check.front() >= prev, "output not sorted");
+      prev = check.front();
+    }
+    bench::check(n == records, "output lost records");
+    std::filesystem::remove(output);
+
+    std::printf("%-7s %6zu %6zu %6zu %8.1f MiB %8.1f MiB %7.2fs %7.2fs\n",
+                packed ? "packed" : "raw", stats.initial_runs, stats.fan_in, stats.merge_passes,
+                mib(stats.bytes_read), mib(stats.bytes_written), stats.run_generation_seconds,
+                secs);
+  }
+}
@@ -0,0 +1,36 @@
+// Parallel merge scaling from 1 to 64 threads against the sequential merge.
+//
+// usage: bench_parallel_merge [K] [elements_per_run]
+
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "bench_util.hpp"
+#include "nway/loser_tree.hpp"
+#include "nway/parallel_merge.hpp"
+
+int main(int argc, char** argv) {
+  const std::size_t k = bench::arg_size(argc, argv, 1, 1024);
+  const std::size_t per_run = bench::arg_size(argc, argv, 2, 16384);
+  const auto runs = bench::random_runs(k, per_run);
+  const std::size_t n = k * per_run;
+
+  std::vector<std::uint64_t> expected(n), out(n);
+  bench::Timer t_seq;
+  nway::loser_tree_merge(runs, expected.begin());
+  const double seq = t_seq.seconds();
+
+  std::printf("K=%zu, %zu elements, %u hardware threads\n", k, n,
+              std::thread::hardware_concurrency());
+  std::printf("%8s %12s %12s %10s\n", "threads", "seconds", "Melem/s", "speedup");
+  std::printf("%8s %12.4f %12.1f %10s\n", "seq", seq, n / seq / 1e6, "1.00x");
+  for (std::size_t threads = 1; threads <= 64; threads *= 2) {
+    std::fill(out.begin(), out.end(), 0);
+    bench::Timer t;
+    nway::parallel_merge(runs, out.begin(), threads);
+    const double secs = t.seconds();
+    bench::check(out == expected, "parallel merge differs from sequential merge");
+    std::printf("%8zu %12.4f %12.1f %9.2fx\n", threads, secs, n / secs / 1e6, seq / secs);
+  }
+}
@@ -0,0 +1,84 @@
+// Radix-partitioned merge vs. the multi-sequence selection parallel merge on
+// uniform and skewed integer keys, and which one parallel_merge() picks from
+// its sampled histogram. The selection path is forced with an opaque
+// comparator. Keys are u * 1e18 for uniform u, a range that is not a power of
+// two; skewed keys are u^4 * 1e18, piling up near zero.
+//
+// usage: bench_radix_merge [K] [elements_per_run] [threads]
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "bench_util.hpp"
+#include "nway/loser_tree.hpp"
+#include "nway/parallel_merge.hpp"
+#include "nway/radix_merge.hpp"
+
+namespace {
+
+std::vector<std::vector<std::uint64_t>> make_runs(std::size_t k, std::size_t n, bool skewed) {
+  std::mt19937_64 rng(3);
+  std::uniform_real_distribution<double> unit(0.0, 1.0);
+  std::vector<std::vector<std::uint64_t>> runs(k);
+  for (auto& run : runs) {
+    run.resize(n);
+    for (auto& x : run) {
+      const double u = unit(rng);
+      x = static_cast<std::uint64_t>((skewed ? std::pow(u, 4) : u) * 1e18);
+    }
+    std::sort(run.begin(), run.end());
+  }
+  return runs;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t k = bench::arg_size(argc, argv, 1, 256);
+  const std::size_t per_run = bench::arg_size(argc, argv, 2, 32768);
+  const std::size_t threads =
+      bench::arg_size(argc, argv, 3, std::max(1u, std::thread::hardware_concurrency()));
+  const std::size_t n = k * per_run;
+  std::printf("K=%zu, %zu elements, %zu threads, %zu buckets, ns per element\n", k, n, threads,
+              4 * threads);
+  std::printf("%-8s %10s %10s %10s %10s %10s\n", "keys", "sequential", "select", "radix",
+              "auto", "picked");
+  for (bool skewed : {false, true}) {
+    const auto runs = make_runs(k, per_run, skewed);
+    if (!skewed)
+      bench::check(nway::radix_balanced(runs, 4 * threads), "uniform keys judged unbalanced");
+    std::vector<std::uint64_t> expected(n), out(n);
+    const auto opaque = [](std::uint64_t a, std::uint64_t b) { return a < b; };
+
+    bench::Timer t_seq;
+    nway::loser_tree_merge(runs, expected.begin());
+    const double s_seq = t_seq.seconds();
+    bench::Timer t_select;
+    nway::parallel_merge(runs, out.begin(), threads, opaque);
+    const double s_select = t_select.seconds();
+    bench::check(out == expected, "selection merge differs");
+    bench::Timer t_radix;
+    nway::radix_merge(runs, out.begin(), threads, 4 * threads);
+    const double s_radix = t_radix.seconds();
+    bench::check(out == expected, "radix merge differs");
+    bench::Timer t_auto;
+    nway::parallel_merge(runs, out.begin(), threads);
+    const double s_auto = t_auto.seconds();
+    bench::check(out == expected, "parallel merge differs");
+
+    // What parallel_merge() dispatches to: it first caps the workers so none
+    // gets less than kMinParallelSlice elements, and one worker means the
+    // sequential loser tree.
+    const std::size_t used = std::clamp<std::size_t>(n / nway::kMinParallelSlice, 1, threads);
+    const char* picked = used == 1                              ? "sequential"
+                         : nway::radix_balanced(runs, 4 * used) ? "radix"
+                                                                : "select";
+    const double per = 1e9 / double(n);
+    std::printf("%-8s %10.2f %10.2f %10.2f %10.2f %10s\n", skewed ? "skewed" : "uniform",
+                s_seq * per, s_select * per, s_radix * per, s_auto * per, picked);
+  }
+}
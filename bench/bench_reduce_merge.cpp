@@ -0,0 +1,100 @@
+// Merge-reduce of sorted (key, count) lists: one-pass reduce_merge and the
+// streaming views::merge_reduce vs. a full merge into a K-times-larger buffer
+// followed by a second pass that sums adjacent equal keys. Each run holds
+// distinct keys drawn from a universe of `universe` keys, so the reduced
+// output shrinks by up to K times as the universe narrows.
+//
+// usage: bench_reduce_merge [K] [total_elements]
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "bench_util.hpp"
+#include "nway/loser_tree.hpp"
+#include "nway/reduce_merge.hpp"
+
+namespace {
+
+struct KeyCount {
+  std::uint64_t key;
+  std::uint64_t count;
+  bool operator==(const KeyCount&) const = default;
+};
+
+constexpr auto kLess = [](const KeyCount& a, const KeyCount& b) { return a.key < b.key; };
+constexpr auto kAdd = [](KeyCount& acc, const KeyCount& x) { acc.count += x.count; };
+
+std::vector<std::vector<KeyCount>> count_runs(std::size_t k, std::size_t n,
+                                              std::uint64_t universe) {
+  std::mt19937_64 rng(11);
+  std::vector<std::vector<KeyCount>> runs(k);
+  for (auto& run : runs) {
+    run.resize(n);
+    for (auto& x : run) x = {rng() % universe, 1 + rng() % 100};
+    std::sort(run.begin(), run.end(), kLess);
+    std::vector<KeyCount> reduced;
+    for (const auto& x : run) {
+      if (!reduced.empty() && reduced.back().key == x.key)
+        kAdd(reduced.back(), x);
+      else
+        reduced.push_back(x);
+    }
+    run = std::move(reduced);
+  }
+  return runs;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t k = bench::arg_size(argc, argv, 1, 16);
+  const std::size_t total = bench::arg_size(argc, argv, 2, std::size_t(1) << 22);
+  const std::size_t n = total / k;
+  std::printf("K=%zu, ns per input element\n", k);
+  std::printf("%10s %10s %9s %14s %12s %12s %9s\n", "universe", "inputs", "outputs",
+              "merge+reduce", "reduce_merge", "view", "speedup");
+  for (std::uint64_t universe : {std::uint64_t(1) << 40, std::uint64_t(n * 4), std::uint64_t(n),
+                                 std::uint64_t(n / 4), std::uint64_t(n / 64)}) {
+    const auto runs = count_runs(k, n, universe);
+    std::size_t inputs = 0;
+    for (const auto& run : runs) inputs += run.size();
+
+    // Baseline: full-size intermediate, then a second pass.
+    bench::Timer t_two;
+    std::vector<KeyCount> expected(inputs);
+    nway::loser_tree_merge(runs, expected.begin(), kLess);
+    std::size_t m = 0;
+    for (std::size_t i = 0; i < inputs; ++i) {
+      if (m > 0 && expected[m - 1].key == expected[i].key)
+        kAdd(expected[m - 1], expected[i]);
+      else
+        expected[m++] = expected[i];
+    }
+    expected.resize(m);
+    const double s_two = t_two.seconds();
+
+    bench::Timer t_one;
+    std::vector<KeyCount> out;
+    out.reserve(m);
+    nway::reduce_merge(runs, std::back_inserter(out), kAdd, kLess);
+    const double s_one = t_one.seconds();
+    bench::check(out == expected, "reduce_merge differs");
+
+    bench::Timer t_view;
+    std::uint64_t sum = 0, groups = 0;
+    for (const auto& x : nway::views::merge_reduce(runs, kAdd, kLess)) {
+      sum += x.count;
+      ++groups;
+    }
+    const double s_view = t_view.seconds();
+    bench::do_not_optimize(sum);
+    bench::check(groups == m, "merge_reduce view differs");
+
+    const double per = 1e9 / double(inputs);
+    std::printf("%10llu %10zu %9zu %14.2f %12.2f %12.2f %8.2fx\n",
+                static_cast<unsigned long long>(universe), inputs, m, s_two * per, s_one * per,
+                s_view * per, s_two / s_one);
+  }
+}
@@ -0,0 +1,95 @@
+// Run formation for the external sort: chunk sort (sequential and pipelined)
+// vs. replacement selection, on random input and on nearly sorted input
+// (sorted, then 1% of the records replaced by random keys). Reports initial
+// runs, mean run length relative to the memory budget in records and (for
+// replacement selection) to the tree's leaves, merge passes, bytes written
+// and wall time of each phase. For 8-byte keys the tree's per-leaf overhead
+// (node index and flags) takes 6 of every 14 bytes, so "run/leaves" shows
+// the algorithm's ~2x and "run/memory" what is left of it.
+//
+// usage: bench_run_formation [records] [memory_limit_mb] [read_buffer_kb] [temp_dir]
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "bench_util.hpp"
+#include "nway/external_sort.hpp"
+#include "nway/run_file.hpp"
+
+namespace {
+
+void write_input(const std::filesystem::path& path, std::size_t records, bool nearly_sorted) {
+  std::vector<std::uint64_t> v(records);
+  std::mt19937_64 rng(7);
+  for (auto& x : v) x = rng();
+  if (nearly_sorted) {
+    std::sort(v.begin(), v.end());
+    for (std::size_t i = 0; i < records / 100; ++i) v[rng() % records] = rng();
+  }
+  nway::RunWriter<std::uint64_t> w(path, std::size_t(1) << 20);
+  w.write(v.data(), v.size());
+  w.finish();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t records = bench::arg_size(argc, argv, 1, std::size_t(1) << 24);
+  nway::ExternalSortOptions base;
+  base.memory_limit = bench::arg_size(argc, argv, 2, 8) << 20;
+  base.read_buffer = bench::arg_size(argc, argv, 3, 512) << 10;
+  base.write_buffer = base.read_buffer;
+  if (argc > 4) base.temp_dir = argv[4];
+
+  struct Mode {
+    const char* name;
+    nway::RunFormation formation;
+    bool overlap_io;
+  };
+  const Mode modes[] = {
+      {"chunk sort", nway::RunFormation::chunk_sort, false},
+      {"chunk sort, pipelined", nway::RunFormation::chunk_sort, true},
+      {"replacement selection", nway::RunFormation::replacement_selection, false},
+  };
+  const double memory_records = double(base.memory_limit) / sizeof(std::uint64_t);
+  const double leaves = double(nway::detail::replacement_selection_leaves<std::uint64_t>(base));
+
+  nway::TempDir dir(base.temp_dir);
+  const auto input = dir.path() / "input.bin";
+  const auto output = dir.path() / "output.bin";
+  std::printf("%zu records, %zu MiB budget, %zu KiB read buffers, fan-in %zu\n\n", records,
+              base.memory_limit >> 20, base.read_buffer >> 10,
+              nway::external_fan_in<std::uint64_t>(base));
+  std::printf("%-8s %-22s %6s %10s %10s %6s %10s %8s %8s\n", "input", "run formation", "runs",
+              "run/memory", "run/leaves", "passes", "written", "phase 1", "total");
+  for (bool nearly_sorted : {false, true}) {
+    write_input(input, records, nearly_sorted);
+    for (const Mode& mode : modes) {
+      nway::ExternalSortOptions opts = base;
+      opts.run_formation = mode.formation;
+      opts.overlap_io = mode.overlap_io;
+      bench::Timer t;
+      const auto stats = nway::external_sort<std::uint64_t>(input, output, opts);
+      const double secs = t.seconds();
+
+      nway::RunReader<std::uint64_t> check(output, std::size_t(1) << 20);
+      std::uint64_t n = 0, prev = 0;
+      for (; !check.empty(); check.pop(), ++n) {
+        bench::check(check.front() >= prev, "output not sorted");
+        prev = check.front();
+      }
+      bench::check(n == records, "output lost records");
+
+      const double run = double(records) / double(stats.initial_runs);
+      char per_leaf[16] = "-";
+      if (mode.formation == nway::RunFormation::replacement_selection)
+        std::snprintf(per_leaf, sizeof per_leaf, "%.2fx", run / leaves);
+      std::printf("%-8s %-22s %6zu %9.2fx %10s %6zu %6.0f MiB %7.2fs %7.2fs\n",
+                  nearly_sorted ? "nearly" : "random", mode.name, stats.initial_runs,
+                  run / memory_records, per_leaf, stats.merge_passes,
+                  stats.bytes_written / double(1 << 20), stats.run_generation_seconds, secs);
+    }
+  }
+}
@@ -0,0 +1,135 @@
+// Merging run files through each run reader: buffered read(), buffered
+// pread() at explicit offsets, mmap + madvise, and double-buffered async reads
+// (io_uring and the thread-pool fallback).
+//
+// usage: bench_run_readers [K] [records_per_run] [buffer_kb] [temp_dir]
+//
+// Run files are evicted from the page cache (fdatasync + POSIX_FADV_DONTNEED)
+// before each merge so every reader starts cold.
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bench_util.hpp"
+#include "nway/async_run.hpp"
+#include "nway/detail/file.hpp"
+#include "nway/external_sort.hpp"
+#include "nway/mmap_run.hpp"
+#include "nway/run_file.hpp"
+
+namespace {
+
+using Key = std::uint64_t;
+
+void evict(const std::filesystem::path& p) {
+  nway::detail::File f(p, O_RDONLY);
+  ::fdatasync(f.fd());
+  ::posix_fadvise(f.fd(), 0, 0, POSIX_FADV_DONTNEED);
+}
+
+// RunReader over pread(): the baseline mmap is usually measured against. Same
+// buffering as RunReader, but every refill names its file offset.
+class PreadRunReader {
+ public:
+  PreadRunReader(const std::filesystem::path& path, std::size_t buffer_bytes)
+      : file_(nway::detail::File::open_read(path)),
+        buf_(std::max<std::size_t>(1, buffer_bytes / sizeof(Key))) {
+    refill();
+  }
+
+  bool empty() const { return pos_ == len_; }
+  const Key& front() const { return buf_[pos_]; }
+  void pop() {
+    if (++pos_ == len_) refill();
+  }
+
+  std::uint64_t bytes_read() const { return offset_; }
+
+ private:
+  void refill() {
+    const std::size_t got = file_.pread(buf_.data(), buf_.size() * sizeof(Key), offset_);
+    offset_ += got;
+    len_ = got / sizeof(Key);
+    pos_ = 0;
+  }
+
+  nway::detail::File file_;
+  std::vector<Key> buf_;
+  std::uint64_t offset_ = 0;
+  std::size_t pos_ = 0;
+  std::size_t len_ = 0;
+};
+
+// `merge` performs the merge and returns the name of the reader it used.
+template <class Merge>
+void measure(const std::vector<std::filesystem::path>& runs, const std::filesystem::path& out,
+             double mib, Merge merge) {
+  for (const auto& p : runs) evict(p);
+  bench::Timer t;
+  const std::string name = merge();
+  const double secs = t.seconds();
+
+  nway::RunReader<Key> check(out, std::size_t(1) << 20);
+  Key prev = 0;
+  for (; !check.empty(); check.pop()) {
+    bench::check(check.front() >= prev, "merge output not sorted");
+    prev = check.front();
+  }
+  std::printf("%-24s %8.3f s %10.1f MiB/s\n", name.c_str(), secs, mib / secs);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t k = bench::arg_size(argc, argv, 1, 512);
+  const std::size_t per_run = bench::arg_size(argc, argv, 2, std::size_t(1) << 15);
+  const std::size_t buffer = bench::arg_size(argc, argv, 3, 64) << 10;
+  nway::TempDir dir(argc > 4 ? argv[4] : "");
+
+  std::vector<std::filesystem::path> runs;
+  const auto data = bench::random_runs(k, per_run);
+  for (const auto& run : data) {
+    runs.push_back(dir.next_file());
+    nway::RunWriter<Key> w(runs.back(), std::size_t(1) << 20);
+    w.write(run.data(), run.size());
+    w.finish();
+  }
+  const auto out = dir.path() / "merged.bin";
+  const double mib = k * per_run * 8.0 / (1 << 20);
+  const std::size_t wbuf = std::size_t(1) << 20;
+
+  std::printf("K=%zu, %.1f MiB input, %zu KiB buffer/window per run\n", k, mib, buffer >> 10);
+  measure(runs, out, mib, [&] {
+    nway::merge_run_files<Key, nway::RunReader<Key>>(runs, out, buffer, wbuf);
+    return std::string("read");
+  });
+  measure(runs, out, mib, [&] {
+    nway::merge_run_files<Key, PreadRunReader>(runs, out, buffer, wbuf);
+    return std::string("pread");
+  });
+  measure(runs, out, mib, [&] {
+    nway::merge_run_files<Key, nway::MappedRunReader<Key>>(runs, out, buffer, wbuf);
+    return std::string("mmap");
+  });
+  for (auto backend : {nway::AsyncBackend::io_uring, nway::AsyncBackend::thread_pool}) {
+    try {
+      measure(runs, out, mib, [&] {
+        nway::AsyncRunSet<Key> set(runs, buffer, backend);
+        nway::RunWriter<Key> w(out, wbuf);
+        std::less<> comp;
+        nway::detail::merge_cursors(set.cursors(), w, comp);
+        w.finish();
+        return std::string("async ") + set.backend_name();
+      });
+    } catch (const std::exception& e) {
+      std::printf("async backend unavailable: %s\n", e.what());
+    }
+  }
+}
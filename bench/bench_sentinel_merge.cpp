@@ -0,0 +1,77 @@
+// Branchless sentinel loser tree vs. the checked loser tree: time, IPC and
+// branch misses on random and skewed inputs.
+//
+// usage: bench_sentinel_merge [K] [total_elements]
+//
+// "random" runs are equally long with uniform keys. "skewed" runs have
+// Zipf-distributed lengths, so most runs are short and run dry early while a
+// few long ones dominate the output. Hardware counters come from
+// perf_event_open and print as n/a where the host does not expose them.
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "bench_util.hpp"
+#include "nway/loser_tree.hpp"
+#include "nway/sentinel_merge.hpp"
+#include "perf_counters.hpp"
+
+namespace {
+
+using Runs = std::vector<std::vector<std::uint64_t>>;
+
+Runs skewed_runs(std::size_t k, std::size_t total) {
+  std::mt19937_64 rng(7);
+  double norm = 0;
+  for (std::size_t i = 1; i <= k; ++i) norm += 1.0 / i;
+  Runs runs(k);
+  for (std::size_t i = 0; i < k; ++i) {
+    runs[i].resize(static_cast<std::size_t>(total / norm / (i + 1)));
+    for (auto& x : runs[i]) x = rng();
+    std::sort(runs[i].begin(), runs[i].end());
+  }
+  return runs;
+}
+
+template <class Merge>
+void measure(const char* input, const char* engine, const Runs& runs,
+             std::vector<std::uint64_t>& out, Merge merge) {
+  bench::PerfCounters pc;
+  bench::Timer t;
+  pc.start();
+  merge(runs, out.begin());
+  pc.stop();
+  const double secs = t.seconds();
+  const double n = double(out.size());
+  if (pc.available())
+    std::printf("%-7s %-12s %10.2f %8.2f %14.4f %14.4f\n", input, engine, secs * 1e9 / n, pc.ipc(),
+                pc.value(bench::PerfCounters::kBranchMisses) / n,
+                pc.value(bench::PerfCounters::kBranches) / n);
+  else
+    std::printf("%-7s %-12s %10.2f %8s %14s %14s\n", input, engine, secs * 1e9 / n, "n/a", "n/a",
+                "n/a");
+}
+
+void run(const char* input, const Runs& runs) {
+  std::size_t n = 0;
+  for (const auto& r : runs) n += r.size();
+  std::vector<std::uint64_t> expected(n), out(n);
+  measure(input, "checked", runs, expected,
+          [](const Runs& r, auto it) { nway::loser_tree_merge(r, it); });
+  measure(input, "sentinel", runs, out, [](const Runs& r, auto it) { nway::sentinel_merge(r, it); });
+  bench::check(out == expected, "sentinel merge differs");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t k = bench::arg_size(argc, argv, 1, 1024);
+  const std::size_t total = bench::arg_size(argc, argv, 2, std::size_t(1) << 23);
+  std::printf("K=%zu, ~%zu elements\n", k, total);
+  std::printf("%-7s %-12s %10s %8s %14s %14s\n", "input", "engine", "ns/elem", "IPC",
+              "br-miss/elem", "branches/elem");
+  run("random", bench::random_runs(k, total / k));
+  run("skewed", skewed_runs(k, total));
+}
@@ -0,0 +1,50 @@
+// Bitonic merge kernels: elements per second for every key type and every
+// instruction set the host supports, two-way and small K.
+//
+// usage: bench_simd_merge [elements_per_run]
+
+#include <cstdio>
+#include <span>
+#include <vector>
+
+#include "bench_util.hpp"
+#include "nway/loser_tree.hpp"
+#include "nway/simd_merge.hpp"
+
+namespace {
+
+template <class T>
+void bench_type(const char* name, std::size_t per_run) {
+  for (std::size_t k : {2, 4, 8}) {
+    const auto runs = bench::random_runs<T>(k, per_run, k);
+    std::vector<std::span<const T>> spans(runs.begin(), runs.end());
+    const std::size_t n = k * per_run;
+    std::vector<T> expected(n), out(n);
+
+    bench::Timer t_tree;
+    nway::loser_tree_merge(runs, expected.begin());
+    std::printf("%-8s K=%zu %-10s %10.1f Melem/s\n", name, k, "loser-tree",
+                n / t_tree.seconds() / 1e6);
+
+    for (auto level : {nway::SimdLevel::scalar, nway::SimdLevel::avx2, nway::SimdLevel::avx512}) {
+      if (level > nway::simd_level()) continue;
+      const int reps = 5;
+      bench::Timer t;
+      for (int r = 0; r < reps; ++r) nway::simd_merge<T>(spans, out.data(), level);
+      const double secs = t.seconds() / reps;
+      bench::check(out == expected, "SIMD merge differs from loser tree");
+      std::printf("%-8s K=%zu %-10s %10.1f Melem/s\n", name, k, nway::to_string(level),
+                  n / secs / 1e6);
+    }
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t per_run = bench::arg_size(argc, argv, 1, std::size_t(1) << 20);
+  std::printf("host SIMD level: %s\n", nway::to_string(nway::simd_level()));
+  bench_type<std::uint32_t>("uint32", per_run);
+  bench_type<std::uint64_t>("uint64", per_run);
+  bench_type<float>("float", per_run);
+}
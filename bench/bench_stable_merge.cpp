@@ -0,0 +1,66 @@
+// Cost of stability and provenance. `merge()` is the unstable-or-stable-
+// by-accident default; stable_merge packs the run index into the low bits of
+// each key word for integer keys (K <= 8) and otherwise uses the two-field
+// (key, run) loser tree, forced here with an opaque comparator.
+//
+// usage: bench_stable_merge [total_elements]
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "bench_util.hpp"
+#include "nway/merge.hpp"
+#include "nway/stable_merge.hpp"
+
+namespace {
+
+template <class T>
+void bench_k(const char* type, const char* keys, std::size_t k, std::size_t n,
+             std::uint64_t universe) {
+  std::mt19937_64 rng(k);
+  std::vector<std::vector<T>> runs(k);
+  for (auto& run : runs) {
+    run.resize(n);
+    for (auto& x : run) x = static_cast<T>(rng() % universe);
+    std::sort(run.begin(), run.end());
+  }
+  std::vector<T> expected(n * k), out(n * k);
+  std::vector<std::uint32_t> src(n * k), src2(n * k);
+  const auto opaque = [](T a, T b) { return a < b; };
+
+  bench::Timer t_plain;
+  nway::merge(runs, expected.begin());
+  const double s_plain = t_plain.seconds();
+  bench::Timer t_stable;
+  nway::stable_merge(runs, out.begin());
+  const double s_stable = t_stable.seconds();
+  bench::check(out == expected, "stable_merge differs");
+  bench::Timer t_src;
+  nway::stable_merge(runs, out.begin(), src.data());
+  const double s_src = t_src.seconds();
+  bench::Timer t_tree;
+  nway::stable_merge(runs, out.begin(), src2.data(), opaque);
+  const double s_tree = t_tree.seconds();
+  bench::check(out == expected && src == src2, "two-field stable merge differs");
+
+  const double per = 1e9 / double(n * k);
+  std::printf("%-7s %-5s %4zu %10.2f %10.2f %12.2f %12.2f %9.2fx\n", type, keys, k, s_plain * per,
+              s_stable * per, s_src * per, s_tree * per, s_src / s_plain);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t total = bench::arg_size(argc, argv, 1, std::size_t(1) << 23);
+  std::printf("ns per element; dup keys come from total/16 values, rand keys are uniform\n");
+  std::printf("%-7s %-5s %4s %10s %10s %12s %12s %10s\n", "type", "keys", "K", "merge()", "stable",
+              "stable+src", "two-field", "overhead");
+  for (std::size_t k : {2, 4, 8, 16, 64}) {
+    for (std::uint64_t universe : {std::uint64_t(total / 16), std::uint64_t(1) << 32}) {
+      const char* keys = universe == total / 16 ? "dup" : "rand";
+      bench_k<std::uint32_t>("uint32", keys, k, total / k, universe);
+      bench_k<std::uint64_t>("uint64", keys, k, total / k, universe);
+    }
+  }
+}
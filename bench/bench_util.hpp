@@ -0,0 +1,66 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace bench {
+
+class Timer {
+ public:
+  Timer() : start_(std::chrono::steady_clock::now()) {}
+  double seconds() const {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+  }
+
+ private:
+  std::chrono::steady_clock::time_point start_;
+};
+
+template <class T>
+inline void do_not_optimize(const T& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/// `k` sorted runs of `n` uniformly random keys each.
+template <class T = std::uint64_t>
+std::vector<std::vector<T>> random_runs(std::size_t k, std::size_t n, std::uint64_t seed = 42) {
+  std::mt19937_64 rng(seed);
+  std::vector<std::vector<T>> runs(k);
+  for (auto& run : runs) {
+    run.resize(n);
+    for (auto& x : run) x = static_cast<T>(rng());
+    std::sort(run.begin(), run.end());
+  }
+  return runs;
+}
+
+/// Comparator that counts how often it is called.
+struct CountingLess {
+  std::uint64_t* count;
+  template <class T>
+  bool operator()(const T& a, const T& b) const {
+    ++*count;
+    return a < b;
+  }
+};
+
+/// Parses argv[i] as a size, or returns `fallback`.
+inline std::size_t arg_size(int argc, char** argv, int i, std::size_t fallback) {
+  return argc > i ? std::strtoull(argv[i], nullptr, 10) : fallback;
+}
+
+/// Aborts the benchmark when an engine produced a wrong result.
+inline void check(bool ok, const char* what) {
+  if (!ok) {
+    std::fprintf(stderr, "FAILED: %s\n", what);
+    std::exit(1);
+  }
+}
+
+}  // namespace bench
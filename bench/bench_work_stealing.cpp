@@ -0,0 +1,71 @@
+// Tail completion time of the parallel merge with a static split (one output
+// range per thread) vs. work stealing over many smaller ranges. In the skewed
+// workload the comparator is ~50x more expensive for the lowest eighth of the
+// key range, so a rank split hands one thread most of the cost. Reports the
+// makespan, the mean and latest worker finish time, and steals.
+//
+// usage: bench_work_stealing [K] [elements_per_run] [threads]
+
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "bench_util.hpp"
+#include "nway/loser_tree.hpp"
+#include "nway/parallel_merge.hpp"
+
+namespace {
+
+struct SkewedLess {
+  std::uint64_t expensive_below;
+  bool operator()(std::uint64_t a, std::uint64_t b) const {
+    if (a < expensive_below) {
+      std::uint64_t x = a;
+      for (int i = 0; i < 64; ++i) x = x * 6364136223846793005ull + 1442695040888963407ull;
+      bench::do_not_optimize(x);
+    }
+    return a < b;
+  }
+};
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t k = bench::arg_size(argc, argv, 1, 64);
+  const std::size_t per_run = bench::arg_size(argc, argv, 2, 1 << 15);
+  const std::size_t threads =
+      bench::arg_size(argc, argv, 3, std::max(4u, std::thread::hardware_concurrency()));
+  const auto runs = bench::random_runs(k, per_run);
+  const std::size_t n = k * per_run;
+  std::vector<std::uint64_t> expected(n), out(n);
+  nway::loser_tree_merge(runs, expected.begin());
+
+  std::printf("K=%zu, %zu elements, %zu threads, times in ms\n", k, n, threads);
+  std::printf("%-8s %-14s %10s %10s %10s %9s %7s\n", "load", "schedule", "makespan",
+              "mean-done", "last-done", "last/mean", "steals");
+  for (bool skewed : {false, true}) {
+    const SkewedLess comp{skewed ? ~std::uint64_t(0) / 8 : 0};
+    for (std::size_t tasks_per_thread : {std::size_t(1), std::size_t(8), std::size_t(32)}) {
+      nway::WorkStealingStats stats;
+      bench::Timer t;
+      nway::parallel_merge(runs, out.begin(),
+                           nway::ParallelMergeOptions{.threads = threads,
+                                                      .tasks_per_thread = tasks_per_thread,
+                                                      .stats = &stats},
+                           comp);
+      const double secs = t.seconds();
+      bench::check(out == expected, "parallel merge differs from sequential merge");
+      double mean = 0, last = 0;
+      for (double f : stats.finish_seconds) {
+        mean += f / double(stats.finish_seconds.size());
+        last = std::max(last, f);
+      }
+      char schedule[32];
+      std::snprintf(schedule, sizeof(schedule), tasks_per_thread == 1 ? "static" : "steal x%zu",
+                    tasks_per_thread);
+      std::printf("%-8s %-14s %10.1f %10.1f %10.1f %9.2f %7zu\n", skewed ? "skewed" : "uniform",
+                  schedule, secs * 1e3, mean * 1e3, last * 1e3, last / mean, stats.steals);
+    }
+  }
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+namespace bench {
+
+/// Hardware counters for the calling thread via perf_event_open. Counters the
+/// kernel or hypervisor does not expose read as unavailable.
+class PerfCounters {
+ public:
+  enum Event { kCycles, kInstructions, kBranches, kBranchMisses, kCount };
+
+  PerfCounters() {
+    static constexpr std::uint64_t configs[kCount] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_BRANCH_INSTRUCTIONS,
+        PERF_COUNT_HW_BRANCH_MISSES};
+    for (int e = 0; e < kCount; ++e) {
+      perf_event_attr attr;
+      std::memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.config = configs[e];
+      attr.disabled = 1;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      fds_[e] = static_cast<int>(::syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+  }
+  PerfCounters(const PerfCounters&) = delete;
+  PerfCounters& operator=(const PerfCounters&) = delete;
+  ~PerfCounters() {
+    for (int fd : fds_)
+      if (fd >= 0) ::close(fd);
+  }
+
+  bool available() const { return fds_[kInstructions] >= 0; }
+
+  void start() {
+    for (int fd : fds_) {
+      if (fd < 0) continue;
+      ::ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+      ::ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+  }
+
+  void stop() {
+    for (int e = 0; e < kCount; ++e) {
+      values_[e] = 0;
+      if (fds_[e] < 0) continue;
+      ::ioctl(fds_[e], PERF_EVENT_IOC_DISABLE, 0);
+      if (::read(fds_[e], &values_[e], sizeof(values_[e])) != sizeof(values_[e])) values_[e] = 0;
+    }
+  }
+
+  std::uint64_t value(Event e) const { return values_[e]; }
+  double ipc() const {
+    return values_[kCycles] ? double(values_[kInstructions]) / values_[kCycles] : 0.0;
+  }
+
+ private:
+  std::array<int, kCount> fds_{};
+  std::array<std::uint64_t, kCount> values_{};
+};
+
+}  // namespace bench
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "detail/aligned_allocator.hpp"
+
+namespace nway {
+
+/// Bump allocator for per-call scratch that is released all at once. Objects
+/// live in one cache-aligned block; an allocation that does not fit gets its
+/// own overflow block, and the next reset() replaces everything with a single
+/// block big enough for the whole cycle. After one cycle at peak size the
+/// arena therefore never touches the heap again.
+///
+/// Only trivially destructible types: reset() runs no destructors. Every block
+/// is cache-line aligned, which bounds the alignment a type may ask for.
+class Arena {
+ public:
+  explicit Arena(std::size_t bytes = 0) {
+    if (bytes > 0) block_ = Block(bytes);
+  }
+
+  /// `n` default-initialised objects of type T, valid until reset().
+  template <class T>
+    requires std::is_trivially_destructible_v<T>
+  std::span<T> allocate(std::size_t n) {
+    static_assert(alignof(T) <= detail::kCacheLine, "Arena blocks are only cache-line aligned");
+    constexpr std::size_t align = std::max(alignof(T), alignof(std::max_align_t));
+    const std::size_t bytes = n * sizeof(T);
+    std::size_t offset = (used_ + align - 1) & ~(align - 1);
+    std::byte* p;
+    if (offset + bytes <= block_.size) {
+      p = block_.data + offset;
+    } else {
+      overflow_.emplace_back(bytes);
+      p = overflow_.back().data;
+    }
+    // Overflowed requests are accounted as if they had fit, so reset() can size
+    // one block for the whole cycle.
+    used_ = offset + bytes;
+    high_water_ = std::max(high_water_, used_);
+    T* first = reinterpret_cast<T*>(p);
+    std::uninitialized_default_construct_n(first, n);
+    return {first, n};
+  }
+
+  /// Releases every allocation. Grows the block to this cycle's high-water
+  /// mark if anything overflowed.
+  void reset() {
+    if (!overflow_.empty()) {
+      overflow_.clear();
+      block_ = Block(std::bit_ceil(high_water_));
+    }
+    used_ = 0;
+  }
+
+  std::size_t capacity() const { return block_.size; }
+  std::size_t used() const { return used_; }
+
+ private:
+  struct Block {
+    std::byte* data = nullptr;
+    std::size_t size = 0;
+
+    Block() = default;
+    explicit Block(std::size_t bytes)
+        : data(static_cast<std::byte*>(::operator new(bytes, std::align_val_t(detail::kCacheLine)))),
+          size(bytes) {}
+    Block(Block&& other) noexcept
+        : data(std::exchange(other.data, nullptr)), size(std::exchange(other.size, 0)) {}
+    Block& operator=(Block&& other) noexcept {
+      std::swap(data, other.data);
+      std::swap(size, other.size);
+      return *this;
+    }
+    ~Block() {
+      if (data) ::operator delete(data, std::align_val_t(detail::kCacheLine));
+    }
+  };
+
+  Block block_;
+  std::vector<Block> overflow_;
+  std::size_t used_ = 0;
+  std::size_t high_water_ = 0;
+};
+
+}  // namespace nway
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <sys/uio.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
+#include "detail/aligned_allocator.hpp"
+#include "detail/file.hpp"
+#include "detail/read_queue.hpp"
+
+namespace nway {
+
+enum class AsyncBackend { automatic, io_uring, thread_pool };
+
+/// Double-buffered asynchronous readers over K run files sharing one read
+/// queue. While the merge consumes one buffer of a run, the read for its
+/// other buffer is already in flight, so a cursor only blocks when its run is
+/// genuinely starved.
+///
+/// The backend is io_uring with the 2K buffers registered up front (falling
+/// back to unregistered reads if registration is refused) or, when io_uring
+/// is unavailable, a small pool of threads issuing pread().
+template <class T>
+class AsyncRunSet {
+  static_assert(std::is_trivially_copyable_v<T>, "run records must be trivially copyable");
+
+ public:
+  /// Same interface as RunReader: empty() / front() / pop().
+  class Cursor {
+   public:
+    bool empty() const { return pos_ == len_; }
+    const T& front() const { return data_[pos_]; }
+    void pop() {
+      if (++pos_ == len_) set_->refill(*this);
+    }
+
+   private:
+    friend AsyncRunSet;
+    AsyncRunSet* set_ = nullptr;
+    std::size_t index_ = 0;
+    const T* data_ = nullptr;
+    std::size_t pos_ = 0;
+    std::size_t len_ = 0;
+  };
+
+  AsyncRunSet(const std::vector<std::filesystem::path>& paths, std::size_t buffer_bytes,
+              AsyncBackend backend = AsyncBackend::automatic)
+      : buffer_bytes_(std::max(sizeof(T), buffer_bytes / sizeof(T) * sizeof(T))),
+        runs_(paths.size()),
+        cursors_(paths.size()),
+        memory_(2 * buffer_bytes_ * paths.size()) {
+    std::vector<iovec> iov(paths.size());
+    for (std::size_t i = 0; i < paths.size(); ++i) {
+      Run& r = runs_[i];
+      r.file = detail::File::open_read(paths[i]);
+      r.size = r.file.size();
+      if (r.size % sizeof(T) != 0) throw std::runtime_error("truncated record in " + paths[i].string());
+      r.buf[0] = memory_.data() + 2 * i * buffer_bytes_;
+      r.buf[1] = r.buf[0] + buffer_bytes_;
+      iov[i] = {r.buf[0], 2 * buffer_bytes_};
+      cursors_[i].set_ = this;
+      cursors_[i].index_ = i;
+    }
+
+    if (backend != AsyncBackend::thread_pool) {
+      try {
+        queue_ = std::make_unique<detail::IoUringReadQueue>(static_cast<unsigned>(runs_.size()), iov);
+      } catch (const std::system_error&) {
+        if (backend == AsyncBackend::io_uring) throw;
+      }
+    }
+    if (!queue_) queue_ = std::make_unique<detail::ThreadPoolReadQueue>();
+
+    // Buffer 0 of every run is read first and handed to the cursor, which
+    // immediately queues the read for buffer 1.
+    try {
+      for (std::size_t i = 0; i < runs_.size(); ++i) issue(i);
+      for (auto& c : cursors_) refill(c);
+    } catch (...) {
+      drain();
+      throw;
+    }
+  }
+  AsyncRunSet(const AsyncRunSet&) = delete;
+  AsyncRunSet& operator=(const AsyncRunSet&) = delete;
+  ~AsyncRunSet() { drain(); }
+
+  std::vector<Cursor>& cursors() { return cursors_; }
+  const char* backend_name() const { return queue_->name(); }
+  /// Bytes of completed reads over all runs.
+  std::uint64_t bytes_read() const { return bytes_read_; }
+
+ private:
+  struct Run {
+    detail::File file;
+    std::uint64_t size = 0;
+    std::uint64_t next_offset = 0;
+    unsigned char* buf[2] = {nullptr, nullptr};
+    int filling = 0;  // buffer the pending read targets
+    bool pending = false;
+    bool ready = false;
+    std::uint32_t want = 0;
+    std::uint64_t offset = 0;
+  };
+
+  // The kernel or a worker may still be writing into our buffers.
+  void drain() {
+    for (; in_flight_ > 0; --in_flight_) queue_->wait();
+  }
+
+  // Starts the read of the next chunk of run `i` into its idle buffer.
+  void issue(std::size_t i) {
+    Run& r = runs_[i];
+    if (r.next_offset >= r.size) return;
+    r.want = static_cast<std::uint32_t>(std::min<std::uint64_t>(buffer_bytes_, r.size - r.next_offset));
+    r.offset = r.next_offset;
+    r.next_offset += r.want;
+    r.pending = true;
+    ++in_flight_;
+    queue_->submit({i, r.file.fd(), r.buf[r.filling], r.want, r.offset, static_cast<int>(i)});
+  }
+
+  void complete(const detail::ReadCompletion& c) {
+    --in_flight_;
+    Run& r = runs_[c.tag];
+    if (c.result < 0)
+      throw std::system_error(static_cast<int>(-c.result), std::generic_category(),
+                              "async read " + r.file.path().string());
+    // Short reads are rare on regular files; finish them synchronously.
+    const auto got = static_cast<std::size_t>(c.result);
+    if (got < r.want &&
+        r.file.pread(r.buf[r.filling] + got, r.want - got, r.offset + got) != r.want - got)
+      throw std::runtime_error("run file shrank: " + r.file.path().string());
+    bytes_read_ += r.want;
+    r.pending = false;
+    r.ready = true;
+  }
+
+  // Slow path of Cursor::pop(): switch the cursor to the run's other buffer.
+  void refill(Cursor& cur) {
+    Run& r = runs_[cur.index_];
+    if (!r.pending && !r.ready) {
+      cur.pos_ = cur.len_ = 0;
+      return;
+    }
+    detail::ReadCompletion c;
+    while (queue_->poll(c)) complete(c);
+    while (!r.ready) complete(queue_->wait());
+
+    r.ready = false;
+    cur.data_ = reinterpret_cast<const T*>(r.buf[r.filling]);
+    cur.pos_ = 0;
+    cur.len_ = r.want / sizeof(T);
+    r.filling ^= 1;
+    issue(cur.index_);
+  }
+
+  std::size_t buffer_bytes_;
+  std::vector<Run> runs_;
+  std::vector<Cursor> cursors_;
+  std::vector<unsigned char, detail::AlignedAllocator<unsigned char, 4096>> memory_;
+  std::unique_ptr<detail::ReadQueue> queue_;
+  std::size_t in_flight_ = 0;
+  std::uint64_t bytes_read_ = 0;
+};
+
+}  // namespace nway
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#ifdef NWAY_HAVE_LZ4
+#include <lz4.h>
+#endif
+#ifdef NWAY_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace nway {
+
+/// Block compressors for compressed run files (compressed_run.hpp). Which
+/// ones exist is decided at build time: CMake defines NWAY_HAVE_LZ4 and
+/// NWAY_HAVE_ZSTD when it finds the libraries. `none` stores blocks as they
+/// are and is always available.
+enum class BlockCodec : std::uint32_t { none = 0, lz4 = 1, zstd = 2 };
+
+/// zstd level for spill blocks: fast, yet well ahead of lz4 in ratio.
+inline constexpr int kZstdLevel = 1;
+
+inline const char* to_string(BlockCodec codec) {
+  switch (codec) {
+    case BlockCodec::lz4: return "lz4";
+    case BlockCodec::zstd: return "zstd";
+    default: return "none";
+  }
+}
+
+inline constexpr bool block_codec_available(BlockCodec codec) {
+  switch (codec) {
+    case BlockCodec::none: return true;
+#ifdef NWAY_HAVE_LZ4
+    case BlockCodec::lz4: return true;
+#endif
+#ifdef NWAY_HAVE_ZSTD
+    case BlockCodec::zstd: return true;
+#endif
+    default: return false;
+  }
+}
+
+/// The best codec built in: zstd, else lz4, else none.
+inline constexpr BlockCodec default_block_codec() {
+  if (block_codec_available(BlockCodec::zstd)) return BlockCodec::zstd;
+  if (block_codec_available(BlockCodec::lz4)) return BlockCodec::lz4;
+  return BlockCodec::none;
+}
+
+namespace detail {
+
+inline void check_codec(BlockCodec codec) {
+  if (!block_codec_available(codec))
+    throw std::invalid_argument(std::string("block codec not built in: ") + to_string(codec));
+}
+
+}  // namespace detail
+
+/// Largest compressed size of `n` bytes.
+inline std::size_t compress_bound(BlockCodec codec, std::size_t n) {
+  detail::check_codec(codec);
+  switch (codec) {
+#ifdef NWAY_HAVE_LZ4
+    case BlockCodec::lz4: return static_cast<std::size_t>(LZ4_compressBound(static_cast<int>(n)));
+#endif
+#ifdef NWAY_HAVE_ZSTD
+    case BlockCodec::zstd: return ZSTD_compressBound(n);
+#endif
+    default: return n;
+  }
+}
+
+/// Compresses `n` bytes into `dst` (at least compress_bound() bytes) and
+/// returns the compressed size.
+inline std::size_t compress_block(BlockCodec codec, const void* src, std::size_t n, void* dst,
+                                  std::size_t capacity) {
+  detail::check_codec(codec);
+  switch (codec) {
+#ifdef NWAY_HAVE_LZ4
+    case BlockCodec::lz4: {
+      const int r = LZ4_compress_default(static_cast<const char*>(src), static_cast<char*>(dst),
+                                         static_cast<int>(n), static_cast<int>(capacity));
+      if (r <= 0) throw std::runtime_error("lz4 compression failed");
+      return static_cast<std::size_t>(r);
+    }
+#endif
+#ifdef NWAY_HAVE_ZSTD
+    case BlockCodec::zstd: {
+      const std::size_t r = ZSTD_compress(dst, capacity, src, n, kZstdLevel);
+      if (ZSTD_isError(r)) throw std::runtime_error(std::string("zstd: ") + ZSTD_getErrorName(r));
+      return r;
+    }
+#endif
+    default:
+      if (capacity < n) throw std::invalid_argument("compress_block: destination too small");
+      std::memcpy(dst, src, n);
+      return n;
+  }
+}
+
+/// Decompresses `n` bytes from `src` into exactly `raw` bytes at `dst`;
+/// throws std::runtime_error when the block is corrupt.
+inline void decompress_block(BlockCodec codec, const void* src, std::size_t n, void* dst,
+                             std::size_t raw) {
+  detail::check_codec(codec);
+  switch (codec) {
+#ifdef NWAY_HAVE_LZ4
+    case BlockCodec::lz4: {
+      const int r = LZ4_decompress_safe(static_cast<const char*>(src), static_cast<char*>(dst),
+                                        static_cast<int>(n), static_cast<int>(raw));
+      if (r < 0 || static_cast<std::size_t>(r) != raw)
+        throw std::runtime_error("corrupt lz4 block");
+      return;
+    }
+#endif
+#ifdef NWAY_HAVE_ZSTD
+    case BlockCodec::zstd: {
+      const std::size_t r = ZSTD_decompress(dst, raw, src, n);
+      if (ZSTD_isError(r) || r != raw) throw std::runtime_error("corrupt zstd block");
+      return;
+    }
+#endif
+    default:
+      if (n != raw) throw std::runtime_error("corrupt stored block");
+      std::memcpy(dst, src, n);
+  }
+}
+
+}  // namespace nway
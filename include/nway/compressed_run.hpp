@@ -0,0 +1,303 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "block_codec.hpp"
+#include "detail/file.hpp"
+#include "detail/worker_pool.hpp"
+
+namespace nway {
+
+/// Decoded blocks each run of a CompressedRunSet keeps: the one the merge
+/// reads plus those decompressed ahead of it.
+inline constexpr std::size_t kCompressedAhead = 2;
+
+namespace detail {
+
+// Precedes every block. A block that does not shrink is stored as is, with
+// codec `none`.
+struct CompressedHeader {
+  std::uint32_t raw_bytes;
+  std::uint32_t stored_bytes;
+  std::uint32_t codec;
+  std::uint32_t reserved;
+};
+static_assert(sizeof(CompressedHeader) == 16);
+
+}  // namespace detail
+
+/// Writer of a block-compressed run: records are gathered into blocks of
+/// `block_bytes` and each block is compressed with `codec` on its own, so
+/// readers can decompress blocks independently and out of line. Same
+/// interface as RunWriter; finish() must be called to flush.
+template <class T>
+class CompressedRunWriter {
+  static_assert(std::is_trivially_copyable_v<T>, "run records must be trivially copyable");
+
+ public:
+  CompressedRunWriter(const std::filesystem::path& path, std::size_t block_bytes,
+                      BlockCodec codec = default_block_codec())
+      : file_(detail::File::create(path)),
+        cap_(std::clamp<std::size_t>(block_bytes / sizeof(T), 1,
+                                     (std::size_t(1) << 30) / sizeof(T))),
+        buf_(new T[cap_]),
+        codec_(codec),
+        out_cap_(compress_bound(codec, cap_ * sizeof(T))),
+        out_(new std::byte[sizeof(detail::CompressedHeader) + out_cap_]) {}
+
+  /// Bytes a writer built with `block_bytes` holds: the block being gathered
+  /// and its compressed image.
+  static std::size_t footprint(std::size_t block_bytes, BlockCodec codec = default_block_codec()) {
+    const std::size_t cap =
+        std::clamp<std::size_t>(block_bytes / sizeof(T), 1, (std::size_t(1) << 30) / sizeof(T));
+    return cap * sizeof(T) + sizeof(detail::CompressedHeader) +
+           compress_bound(codec, cap * sizeof(T));
+  }
+
+  void push(const T& value) {
+    buf_[len_++] = value;
+    if (len_ == cap_) flush();
+  }
+
+  void write(const T* data, std::size_t n) {
+    while (n > 0) {
+      const std::size_t take = std::min(n, cap_ - len_);
+      std::copy_n(data, take, buf_.get() + len_);
+      len_ += take;
+      data += take;
+      n -= take;
+      if (len_ == cap_) flush();
+    }
+  }
+
+  void finish() {
+    flush();
+    file_.close();
+  }
+
+  /// Compressed bytes so far, headers included; exact after finish().
+  std::uint64_t bytes_written() const { return written_; }
+
+ private:
+  void flush() {
+    if (len_ == 0) return;
+    const std::size_t raw = len_ * sizeof(T);
+    std::byte* payload = out_.get() + sizeof(detail::CompressedHeader);
+    detail::CompressedHeader h{static_cast<std::uint32_t>(raw), 0,
+                               static_cast<std::uint32_t>(codec_), 0};
+    std::size_t stored = compress_block(codec_, buf_.get(), raw, payload, out_cap_);
+    if (stored >= raw) {
+      std::memcpy(payload, buf_.get(), raw);
+      stored = raw;
+      h.codec = static_cast<std::uint32_t>(BlockCodec::none);
+    }
+    h.stored_bytes = static_cast<std::uint32_t>(stored);
+    std::memcpy(out_.get(), &h, sizeof h);
+    file_.write(out_.get(), sizeof h + stored);
+    written_ += sizeof h + stored;
+    len_ = 0;
+  }
+
+  detail::File file_;
+  std::size_t cap_;
+  std::unique_ptr<T[]> buf_;
+  std::size_t len_ = 0;
+  BlockCodec codec_;
+  std::size_t out_cap_;
+  std::unique_ptr<std::byte[]> out_;
+  std::uint64_t written_ = 0;
+};
+
+/// Readers over K block-compressed run files (CompressedRunWriter) whose
+/// decompression runs on a shared pool of worker threads. Each run owns
+/// `ahead` block slots: while the merge reads one, the pool reads and
+/// decompresses the run's next blocks into the others, and as soon as the
+/// merge releases a slot the run's next block is queued for it. The merge
+/// thread never decompresses; it only waits when a run has used up every
+/// block decoded ahead of it. Trades spare cores for disk bandwidth.
+template <class T>
+class CompressedRunSet {
+  static_assert(std::is_trivially_copyable_v<T>, "run records must be trivially copyable");
+
+ public:
+  /// Same interface as RunReader: empty() / front() / pop().
+  class Cursor {
+   public:
+    bool empty() const { return pos_ == len_; }
+    const T& front() const { return data_[pos_]; }
+    void pop() {
+      if (++pos_ == len_) set_->next_block(*this);
+    }
+
+   private:
+    friend CompressedRunSet;
+    CompressedRunSet* set_ = nullptr;
+    std::size_t index_ = 0;
+    const T* data_ = nullptr;
+    std::size_t pos_ = 0;
+    std::size_t len_ = 0;
+    bool holding_ = false;  // the run's head slot is being read
+  };
+
+  /// `workers == 0` uses one per core.
+  explicit CompressedRunSet(const std::vector<std::filesystem::path>& paths,
+                            std::size_t workers = 0, std::size_t ahead = kCompressedAhead)
+      : runs_(new Run[paths.size()]),
+        cursors_(paths.size()),
+        ahead_(std::max<std::size_t>(ahead, 1)),
+        pool_(workers != 0 ? workers : std::max(1u, std::thread::hardware_concurrency())) {
+    for (std::size_t i = 0; i < paths.size(); ++i) {
+      runs_[i].file = detail::File::open_read(paths[i]);
+      runs_[i].slots.resize(ahead_);
+      cursors_[i].set_ = this;
+      cursors_[i].index_ = i;
+    }
+    for (std::size_t i = 0; i < paths.size(); ++i) {
+      std::lock_guard lock(runs_[i].mu);
+      schedule(i);
+    }
+    for (auto& c : cursors_) next_block(c);
+  }
+  CompressedRunSet(const CompressedRunSet&) = delete;
+  CompressedRunSet& operator=(const CompressedRunSet&) = delete;
+  ~CompressedRunSet() {
+    for (std::size_t i = 0; i < cursors_.size(); ++i) {
+      std::lock_guard lock(runs_[i].mu);
+      runs_[i].stopping = true;
+    }
+  }
+
+  std::vector<Cursor>& cursors() { return cursors_; }
+  /// Compressed bytes the workers have fetched, headers included.
+  std::uint64_t bytes_read() const { return bytes_read_.load(std::memory_order_relaxed); }
+
+ private:
+  struct Slot {
+    std::unique_ptr<T[]> keys;
+    std::size_t cap = 0;
+    std::size_t n = 0;
+    std::unique_ptr<std::byte[]> stored;
+    std::size_t stored_cap = 0;
+    bool ready = false;
+  };
+
+  struct Run {
+    detail::File file;
+    std::uint64_t offset = 0;  // next block to fetch; only the job in flight touches it
+    std::vector<Slot> slots;
+    std::size_t head = 0;    // slot the cursor reads
+    std::size_t queued = 0;  // slots from head on that are ready or being filled
+    bool in_flight = false;
+    bool eof = false;
+    bool stopping = false;
+    std::exception_ptr error;
+    std::mutex mu;
+    std::condition_variable cv;
+  };
+
+  // Queues the run's next block when a slot is free and no fetch is running
+  // (one at a time per run: each block's offset comes from the one before).
+  // Called with the run's mutex held.
+  void schedule(std::size_t i) {
+    Run& r = runs_[i];
+    if (r.in_flight || r.eof || r.stopping || r.error || r.queued == ahead_) return;
+    const std::size_t slot = (r.head + r.queued) % ahead_;
+    r.in_flight = true;
+    ++r.queued;
+    pool_.submit([this, i, slot] { fetch(i, slot); });
+  }
+
+  // Worker side: reads and decompresses one block into `slot`.
+  void fetch(std::size_t i, std::size_t slot) {
+    Run& r = runs_[i];
+    Slot& s = r.slots[slot];
+    bool end = false;
+    std::exception_ptr error;
+    try {
+      detail::CompressedHeader h;
+      const std::size_t got = r.file.pread(&h, sizeof h, r.offset);
+      if (got == 0) {
+        end = true;
+      } else {
+        if (got != sizeof h || h.raw_bytes == 0 || h.raw_bytes % sizeof(T) != 0)
+          throw std::runtime_error("corrupt block header in " + r.file.path().string());
+        const std::size_t n = h.raw_bytes / sizeof(T);
+        if (s.cap < n) {
+          s.keys.reset(new T[n]);
+          s.cap = n;
+        }
+        // Stored blocks are read in place; others go through a staging buffer.
+        const bool stored = static_cast<BlockCodec>(h.codec) == BlockCodec::none;
+        if (!stored && s.stored_cap < h.stored_bytes) {
+          s.stored.reset(new std::byte[h.stored_bytes]);
+          s.stored_cap = h.stored_bytes;
+        }
+        void* dst = stored ? static_cast<void*>(s.keys.get()) : s.stored.get();
+        if ((stored && h.stored_bytes != h.raw_bytes) ||
+            r.file.pread(dst, h.stored_bytes, r.offset + sizeof h) != h.stored_bytes)
+          throw std::runtime_error("truncated block in " + r.file.path().string());
+        if (!stored)
+          decompress_block(static_cast<BlockCodec>(h.codec), s.stored.get(), h.stored_bytes,
+                           s.keys.get(), h.raw_bytes);
+        s.n = n;
+        r.offset += sizeof h + h.stored_bytes;
+        bytes_read_.fetch_add(sizeof h + h.stored_bytes, std::memory_order_relaxed);
+      }
+    } catch (...) {
+      error = std::current_exception();
+    }
+    std::lock_guard lock(r.mu);
+    r.in_flight = false;
+    if (error) {
+      r.error = error;
+    } else if (end) {
+      r.eof = true;
+      --r.queued;
+    } else {
+      s.ready = true;
+      schedule(i);
+    }
+    r.cv.notify_one();
+  }
+
+  // Merge side: releases the slot the cursor finished and waits for the next.
+  void next_block(Cursor& c) {
+    Run& r = runs_[c.index_];
+    std::unique_lock lock(r.mu);
+    if (c.holding_) {
+      r.slots[r.head].ready = false;
+      r.head = (r.head + 1) % ahead_;
+      --r.queued;
+      c.holding_ = false;
+      schedule(c.index_);
+    }
+    r.cv.wait(lock, [&] { return r.error || r.slots[r.head].ready || r.queued == 0; });
+    if (r.error) std::rethrow_exception(r.error);
+    c.pos_ = c.len_ = 0;
+    if (!r.slots[r.head].ready) return;  // end of the run
+    c.data_ = r.slots[r.head].keys.get();
+    c.len_ = r.slots[r.head].n;
+    c.holding_ = true;
+  }
+
+  std::unique_ptr<Run[]> runs_;
+  std::vector<Cursor> cursors_;
+  std::size_t ahead_;
+  std::atomic<std::uint64_t> bytes_read_{0};
+  detail::WorkerPool pool_;  // last: joined before the runs go away
+};
+
+}  // namespace nway
@@ -0,0 +1,190 @@
+#pragma once
+
+// Delta + frame-of-reference bit packing for blocks of unsigned keys, the
+// payload format of packed_run.hpp. Values are laid out vertically: value i
+// goes to lane i % L of L = 32 / sizeof(T) lanes, and each lane packs its
+// values into consecutive words, with the words of all lanes interleaved.
+// Every lane then has the same bit layout, so an AVX2 decoder unpacks L
+// values with one shift/or/and per word and finishes them with an in-register
+// prefix sum, and L consecutive values always share one vector.
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "simd_common.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define NWAY_HAVE_X86_BITPACK 1
+#endif
+
+namespace nway::detail {
+
+/// Keys per packed block (the last block of a run may hold fewer).
+inline constexpr std::size_t kPackedBlock = 256;
+
+template <class T>
+inline constexpr bool is_packed_key_v =
+    std::is_same_v<T, std::uint32_t> || std::is_same_v<T, std::uint64_t>;
+
+/// Block header. Key i of the block is base + (i + 1) * step + sum of the
+/// packed values 0..i, all modulo 2^W: `step` is the smallest gap between
+/// neighbours (the frame of reference), the packed values hold the rest.
+struct PackedHeader {
+  std::uint64_t base;
+  std::uint64_t step;
+  std::uint32_t count;
+  std::uint32_t bits;
+};
+static_assert(sizeof(PackedHeader) == 24);
+
+template <class T>
+struct PackedLayout {
+  static constexpr std::size_t W = 8 * sizeof(T);        // bits per word
+  static constexpr std::size_t L = 32 / sizeof(T);       // lanes
+  static std::size_t words(std::size_t count, unsigned bits) {  // payload words
+    const std::size_t per_lane = (count + L - 1) / L;
+    return (per_lane * bits + W - 1) / W * L;
+  }
+};
+
+/// Encodes `count` (1..kPackedBlock) keys into `out`: the header, then the
+/// payload words. Any sequence round-trips; ascending keys make it small.
+/// Returns the bytes written, at most packed_block_bound<T>().
+template <class T>
+std::size_t pack_block(const T* keys, std::size_t count, std::byte* out) {
+  using Layout = PackedLayout<T>;
+  T step = 0;
+  if (count > 1) {
+    step = static_cast<T>(keys[1] - keys[0]);
+    for (std::size_t i = 2; i < count; ++i) step = std::min(step, static_cast<T>(keys[i] - keys[i - 1]));
+  }
+  T delta[kPackedBlock] = {};
+  T high = 0;
+  for (std::size_t i = 1; i < count; ++i) {
+    delta[i] = static_cast<T>(keys[i] - keys[i - 1] - step);
+    high |= delta[i];
+  }
+  const unsigned bits = static_cast<unsigned>(std::bit_width(high));
+  const PackedHeader h{static_cast<T>(keys[0] - step), step, static_cast<std::uint32_t>(count), bits};
+  std::memcpy(out, &h, sizeof h);
+
+  const std::size_t words = Layout::words(count, bits);
+  T* payload = reinterpret_cast<T*>(out + sizeof h);
+  std::fill_n(payload, words, T(0));
+  for (std::size_t i = 0; i < count && bits > 0; ++i) {
+    const std::size_t lane = i % Layout::L, pos = i / Layout::L * bits;
+    const std::size_t w = pos / Layout::W, off = pos % Layout::W;
+    payload[w * Layout::L + lane] |= static_cast<T>(delta[i] << off);
+    if (off + bits > Layout::W) payload[(w + 1) * Layout::L + lane] |= delta[i] >> (Layout::W - off);
+  }
+  return sizeof h + words * sizeof(T);
+}
+
+template <class T>
+constexpr std::size_t packed_block_bound() {
+  return sizeof(PackedHeader) + kPackedBlock * sizeof(T);
+}
+
+/// Decodes the payload of a block described by `h` into `out`, which has
+/// room for kPackedBlock keys (whole lanes may be written past h.count).
+template <class T>
+void unpack_block_scalar(const PackedHeader& h, const T* payload, T* out) {
+  using Layout = PackedLayout<T>;
+  const T mask = h.bits == Layout::W ? T(~T(0)) : static_cast<T>((T(1) << h.bits) - 1);
+  const T step = static_cast<T>(h.step);
+  T prev = static_cast<T>(h.base);
+  for (std::size_t i = 0; i < h.count; ++i) {
+    T v = 0;
+    if (h.bits > 0) {
+      const std::size_t lane = i % Layout::L, pos = i / Layout::L * h.bits;
+      const std::size_t w = pos / Layout::W, off = pos % Layout::W;
+      v = payload[w * Layout::L + lane] >> off;
+      if (off + h.bits > Layout::W) v |= payload[(w + 1) * Layout::L + lane] << (Layout::W - off);
+      v &= mask;
+    }
+    prev = static_cast<T>(prev + step + v);
+    out[i] = prev;
+  }
+}
+
+}  // namespace nway::detail
+
+#ifdef NWAY_HAVE_X86_BITPACK
+
+NWAY_SIMD_TARGET_BEGIN("avx2")
+
+namespace nway::detail::avx2 {
+
+// One vector of L consecutive keys per lane slot: unpack, add the step, prefix
+// sum across the vector and carry the last key into the next vector.
+inline void unpack_block(const PackedHeader& h, const std::uint32_t* payload, std::uint32_t* out) {
+  const __m256i mask = _mm256_set1_epi32(h.bits == 32 ? -1 : int((1u << h.bits) - 1));
+  const __m256i step = _mm256_set1_epi32(int(std::uint32_t(h.step)));
+  const __m256i last = _mm256_set1_epi32(7);
+  __m256i carry = _mm256_set1_epi32(int(std::uint32_t(h.base)));
+  const std::size_t slots = (h.count + 7) / 8;
+  for (std::size_t j = 0; j < slots; ++j) {
+    __m256i v = _mm256_setzero_si256();
+    if (h.bits > 0) {
+      const std::size_t pos = j * h.bits, w = pos / 32, off = pos % 32;
+      v = _mm256_srl_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(payload + w * 8)),
+                           _mm_cvtsi32_si128(int(off)));
+      if (off + h.bits > 32)
+        v = _mm256_or_si256(
+            v, _mm256_sll_epi32(
+                   _mm256_loadu_si256(reinterpret_cast<const __m256i*>(payload + (w + 1) * 8)),
+                   _mm_cvtsi32_si128(int(32 - off))));
+      v = _mm256_and_si256(v, mask);
+    }
+    v = _mm256_add_epi32(v, step);
+    v = _mm256_add_epi32(v, _mm256_slli_si256(v, 4));
+    v = _mm256_add_epi32(v, _mm256_slli_si256(v, 8));
+    v = _mm256_add_epi32(v, _mm256_blend_epi32(_mm256_setzero_si256(),
+                                               _mm256_permutevar8x32_epi32(v, _mm256_set1_epi32(3)),
+                                               0xF0));
+    v = _mm256_add_epi32(v, carry);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + j * 8), v);
+    carry = _mm256_permutevar8x32_epi32(v, last);
+  }
+}
+
+inline void unpack_block(const PackedHeader& h, const std::uint64_t* payload, std::uint64_t* out) {
+  const __m256i mask =
+      _mm256_set1_epi64x(h.bits == 64 ? -1 : static_cast<long long>((std::uint64_t(1) << h.bits) - 1));
+  const __m256i step = _mm256_set1_epi64x(static_cast<long long>(h.step));
+  __m256i carry = _mm256_set1_epi64x(static_cast<long long>(h.base));
+  const std::size_t slots = (h.count + 3) / 4;
+  for (std::size_t j = 0; j < slots; ++j) {
+    __m256i v = _mm256_setzero_si256();
+    if (h.bits > 0) {
+      const std::size_t pos = j * h.bits, w = pos / 64, off = pos % 64;
+      v = _mm256_srl_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(payload + w * 4)),
+                           _mm_cvtsi32_si128(int(off)));
+      if (off + h.bits > 64)
+        v = _mm256_or_si256(
+            v, _mm256_sll_epi64(
+                   _mm256_loadu_si256(reinterpret_cast<const __m256i*>(payload + (w + 1) * 4)),
+                   _mm_cvtsi32_si128(int(64 - off))));
+      v = _mm256_and_si256(v, mask);
+    }
+    v = _mm256_add_epi64(v, step);
+    v = _mm256_add_epi64(v, _mm256_slli_si256(v, 8));
+    v = _mm256_add_epi64(v, _mm256_blend_epi32(_mm256_setzero_si256(),
+                                               _mm256_permute4x64_epi64(v, _MM_SHUFFLE(1, 1, 1, 1)),
+                                               0xF0));
+    v = _mm256_add_epi64(v, carry);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + j * 4), v);
+    carry = _mm256_permute4x64_epi64(v, _MM_SHUFFLE(3, 3, 3, 3));
+  }
+}
+
+}  // namespace nway::detail::avx2
+
+NWAY_SIMD_TARGET_END
+
+#endif  // NWAY_HAVE_X86_BITPACK
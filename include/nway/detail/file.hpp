@@ -0,0 +1,107 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <system_error>
+#include <utility>
+
+namespace nway::detail {
+
+[[noreturn]] inline void throw_errno(const std::string& what) {
+  throw std::system_error(errno, std::generic_category(), what);
+}
+
+/// Owning POSIX file descriptor with whole-buffer read/write helpers.
+class File {
+ public:
+  File() = default;
+  File(const std::filesystem::path& path, int flags, mode_t mode = 0644)
+      : path_(path), fd_(::open(path.c_str(), flags | O_CLOEXEC, mode)) {
+    if (fd_ < 0) throw_errno("open " + path.string());
+  }
+  File(File&& o) noexcept : path_(std::move(o.path_)), fd_(std::exchange(o.fd_, -1)) {}
+  File& operator=(File&& o) noexcept {
+    if (this != &o) {
+      close();
+      path_ = std::move(o.path_);
+      fd_ = std::exchange(o.fd_, -1);
+    }
+    return *this;
+  }
+  ~File() { close(); }
+
+  static File open_read(const std::filesystem::path& path) { return File(path, O_RDONLY); }
+  static File create(const std::filesystem::path& path) {
+    return File(path, O_WRONLY | O_CREAT | O_TRUNC);
+  }
+
+  int fd() const { return fd_; }
+  const std::filesystem::path& path() const { return path_; }
+
+  std::uint64_t size() const {
+    struct stat st;
+    if (::fstat(fd_, &st) != 0) throw_errno("fstat " + path_.string());
+    return static_cast<std::uint64_t>(st.st_size);
+  }
+
+  /// Reads up to `n` bytes, retrying short reads; returns fewer only at EOF.
+  std::size_t read(void* buf, std::size_t n) {
+    std::size_t done = 0;
+    while (done < n) {
+      ssize_t r = ::read(fd_, static_cast<char*>(buf) + done, n - done);
+      if (r < 0) {
+        if (errno == EINTR) continue;
+        throw_errno("read " + path_.string());
+      }
+      if (r == 0) break;
+      done += static_cast<std::size_t>(r);
+    }
+    return done;
+  }
+
+  /// Positional variant of read(); does not move the file offset.
+  std::size_t pread(void* buf, std::size_t n, std::uint64_t offset) const {
+    std::size_t done = 0;
+    while (done < n) {
+      ssize_t r = ::pread(fd_, static_cast<char*>(buf) + done, n - done,
+                          static_cast<off_t>(offset + done));
+      if (r < 0) {
+        if (errno == EINTR) continue;
+        throw_errno("pread " + path_.string());
+      }
+      if (r == 0) break;
+      done += static_cast<std::size_t>(r);
+    }
+    return done;
+  }
+
+  void write(const void* buf, std::size_t n) {
+    std::size_t done = 0;
+    while (done < n) {
+      ssize_t r = ::write(fd_, static_cast<const char*>(buf) + done, n - done);
+      if (r < 0) {
+        if (errno == EINTR) continue;
+        throw_errno("write " + path_.string());
+      }
+      done += static_cast<std::size_t>(r);
+    }
+  }
+
+  void close() {
+    if (fd_ >= 0) ::close(fd_);
+    fd_ = -1;
+  }
+
+ private:
+  std::filesystem::path path_;
+  int fd_ = -1;
+};
+
+}  // namespace nway::detail
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <type_traits>
+
+namespace nway::detail {
+
+// Integer keys (not bool) in natural ascending order: the engines that work
+// on key bits directly accept exactly these.
+template <class T, class Compare>
+inline constexpr bool is_ordered_int_key_v =
+    std::is_integral_v<T> && !std::is_same_v<T, bool> && sizeof(T) <= sizeof(std::uint64_t) &&
+    (std::is_same_v<Compare, std::less<>> || std::is_same_v<Compare, std::less<T>>);
+
+// Order-preserving map of an integer key to an unsigned word and back:
+// signed keys get their sign bit flipped.
+template <class T>
+std::uint64_t to_ordered(T x) {
+  using U = std::make_unsigned_t<T>;
+  U u = static_cast<U>(x);
+  if constexpr (std::is_signed_v<T>) u ^= U(1) << (std::numeric_limits<U>::digits - 1);
+  return u;
+}
+
+template <class T>
+T from_ordered(std::uint64_t w) {
+  using U = std::make_unsigned_t<T>;
+  U u = static_cast<U>(w);
+  if constexpr (std::is_signed_v<T>) u ^= U(1) << (std::numeric_limits<U>::digits - 1);
+  return static_cast<T>(u);
+}
+
+}  // namespace nway::detail
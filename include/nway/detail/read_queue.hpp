@@ -0,0 +1,258 @@
+#pragma once
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <span>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "file.hpp"
+
+namespace nway::detail {
+
+struct ReadRequest {
+  std::uint64_t tag;
+  int fd;
+  void* buf;
+  std::uint32_t len;
+  std::uint64_t offset;
+  int buf_index;  // registered buffer holding `buf`, or -1
+};
+
+struct ReadCompletion {
+  std::uint64_t tag;
+  std::int64_t result;  // bytes read, or -errno
+};
+
+/// Asynchronous positional reads: submit() never blocks on I/O, completions
+/// come back in any order through wait() or poll().
+class ReadQueue {
+ public:
+  virtual ~ReadQueue() = default;
+  virtual void submit(const ReadRequest& req) = 0;
+  /// Blocks until one submitted read completes.
+  virtual ReadCompletion wait() = 0;
+  /// Returns a completion if one is already available.
+  virtual bool poll(ReadCompletion& out) = 0;
+  virtual const char* name() const = 0;
+};
+
+/// io_uring through raw system calls (no liburing dependency). `buffers` are
+/// registered with the kernel when possible so reads into them use
+/// IORING_OP_READ_FIXED; otherwise plain IORING_OP_READ is used.
+class IoUringReadQueue final : public ReadQueue {
+ public:
+  /// Throws std::system_error when the kernel refuses io_uring.
+  IoUringReadQueue(unsigned max_in_flight, std::span<const iovec> buffers) {
+    unsigned cq = 1;
+    while (cq < std::max(max_in_flight, 2u)) cq <<= 1;
+    io_uring_params p;
+    std::memset(&p, 0, sizeof(p));
+    p.flags = IORING_SETUP_CQSIZE;
+    p.cq_entries = cq;
+    fd_ = static_cast<int>(::syscall(__NR_io_uring_setup, std::min(cq, 4096u), &p));
+    if (fd_ < 0) throw_errno("io_uring_setup");
+
+    try {
+      map_rings(p);
+    } catch (...) {
+      release();
+      throw;
+    }
+
+    // The kernel caps registered buffers at 16384; memlock limits can also
+    // refuse them. Either way unregistered reads still work.
+    if (!buffers.empty() && buffers.size() <= 16384)
+      fixed_ = ::syscall(__NR_io_uring_register, fd_, IORING_REGISTER_BUFFERS, buffers.data(),
+                         static_cast<unsigned>(buffers.size())) == 0;
+  }
+  IoUringReadQueue(const IoUringReadQueue&) = delete;
+  IoUringReadQueue& operator=(const IoUringReadQueue&) = delete;
+  ~IoUringReadQueue() override { release(); }
+
+  bool registered_buffers() const { return fixed_; }
+
+  void submit(const ReadRequest& req) override {
+    // Every entry is handed to the kernel right away, so the ring never fills.
+    const unsigned tail = *sq_tail_;
+    const unsigned idx = tail & sq_mask_;
+    io_uring_sqe& sqe = sqes_[idx];
+    std::memset(&sqe, 0, sizeof(sqe));
+    const bool fixed = fixed_ && req.buf_index >= 0;
+    sqe.opcode = fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+    sqe.fd = req.fd;
+    sqe.addr = reinterpret_cast<std::uint64_t>(req.buf);
+    sqe.len = req.len;
+    sqe.off = req.offset;
+    sqe.user_data = req.tag;
+    if (fixed) sqe.buf_index = static_cast<std::uint16_t>(req.buf_index);
+    sq_array_[idx] = idx;
+    std::atomic_ref<unsigned>(*sq_tail_).store(tail + 1, std::memory_order_release);
+    enter(1, 0, 0);
+  }
+
+  ReadCompletion wait() override {
+    ReadCompletion c;
+    while (!poll(c)) enter(0, 1, IORING_ENTER_GETEVENTS);
+    return c;
+  }
+
+  bool poll(ReadCompletion& out) override {
+    const unsigned head = *cq_head_;
+    if (head == std::atomic_ref<unsigned>(*cq_tail_).load(std::memory_order_acquire)) return false;
+    const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+    out = {cqe.user_data, cqe.res};
+    std::atomic_ref<unsigned>(*cq_head_).store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  const char* name() const override { return fixed_ ? "io_uring (fixed)" : "io_uring"; }
+
+ private:
+  void map_rings(const io_uring_params& p) {
+    sq_ring_bytes_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    cq_ring_bytes_ = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+    const bool single = p.features & IORING_FEAT_SINGLE_MMAP;
+    if (single) sq_ring_bytes_ = cq_ring_bytes_ = std::max(sq_ring_bytes_, cq_ring_bytes_);
+    sq_ring_ = map(sq_ring_bytes_, IORING_OFF_SQ_RING);
+    cq_ring_ = single ? sq_ring_ : map(cq_ring_bytes_, IORING_OFF_CQ_RING);
+    sqes_bytes_ = p.sq_entries * sizeof(io_uring_sqe);
+    sqes_ = static_cast<io_uring_sqe*>(map(sqes_bytes_, IORING_OFF_SQES));
+
+    auto* sq = static_cast<char*>(sq_ring_);
+    sq_tail_ = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+    sq_mask_ = *reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+    auto* cqr = static_cast<char*>(cq_ring_);
+    cq_head_ = reinterpret_cast<unsigned*>(cqr + p.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(cqr + p.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<unsigned*>(cqr + p.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe*>(cqr + p.cq_off.cqes);
+  }
+
+  void release() {
+    if (sqes_) ::munmap(sqes_, sqes_bytes_);
+    if (cq_ring_ && cq_ring_ != sq_ring_) ::munmap(cq_ring_, cq_ring_bytes_);
+    if (sq_ring_) ::munmap(sq_ring_, sq_ring_bytes_);
+    if (fd_ >= 0) ::close(fd_);
+    sqes_ = nullptr;
+    cq_ring_ = sq_ring_ = nullptr;
+    fd_ = -1;
+  }
+
+  void* map(std::size_t bytes, off_t offset) {
+    void* p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, offset);
+    if (p == MAP_FAILED) throw_errno("mmap io_uring ring");
+    return p;
+  }
+
+  void enter(unsigned to_submit, unsigned min_complete, unsigned flags) {
+    while (::syscall(__NR_io_uring_enter, fd_, to_submit, min_complete, flags, nullptr, 0) < 0) {
+      if (errno != EINTR && errno != EAGAIN && errno != EBUSY) throw_errno("io_uring_enter");
+    }
+  }
+
+  int fd_ = -1;
+  bool fixed_ = false;
+  void* sq_ring_ = nullptr;
+  void* cq_ring_ = nullptr;
+  std::size_t sq_ring_bytes_ = 0, cq_ring_bytes_ = 0, sqes_bytes_ = 0;
+  io_uring_sqe* sqes_ = nullptr;
+  unsigned *sq_tail_ = nullptr, *sq_array_ = nullptr;
+  unsigned sq_mask_ = 0;
+  unsigned *cq_head_ = nullptr, *cq_tail_ = nullptr;
+  unsigned cq_mask_ = 0;
+  io_uring_cqe* cqes_ = nullptr;
+};
+
+/// Fallback when io_uring is unavailable: a few threads issuing pread().
+class ThreadPoolReadQueue final : public ReadQueue {
+ public:
+  explicit ThreadPoolReadQueue(unsigned threads = 0) {
+    if (threads == 0) threads = std::clamp(std::thread::hardware_concurrency(), 2u, 16u);
+    for (unsigned i = 0; i < threads; ++i) workers_.emplace_back([this] { run(); });
+  }
+  ThreadPoolReadQueue(const ThreadPoolReadQueue&) = delete;
+  ThreadPoolReadQueue& operator=(const ThreadPoolReadQueue&) = delete;
+  ~ThreadPoolReadQueue() override {
+    {
+      std::lock_guard lock(mu_);
+      stop_ = true;
+    }
+    work_cv_.notify_all();
+    for (auto& t : workers_) t.join();
+  }
+
+  void submit(const ReadRequest& req) override {
+    {
+      std::lock_guard lock(mu_);
+      work_.push_back(req);
+    }
+    work_cv_.notify_one();
+  }
+
+  ReadCompletion wait() override {
+    std::unique_lock lock(mu_);
+    done_cv_.wait(lock, [&] { return !done_.empty(); });
+    ReadCompletion c = done_.front();
+    done_.pop_front();
+    return c;
+  }
+
+  bool poll(ReadCompletion& out) override {
+    std::lock_guard lock(mu_);
+    if (done_.empty()) return false;
+    out = done_.front();
+    done_.pop_front();
+    return true;
+  }
+
+  const char* name() const override { return "thread-pool pread"; }
+
+ private:
+  void run() {
+    for (;;) {
+      ReadRequest req;
+      {
+        std::unique_lock lock(mu_);
+        work_cv_.wait(lock, [&] { return stop_ || !work_.empty(); });
+        if (work_.empty()) return;
+        req = work_.front();
+        work_.pop_front();
+      }
+      std::int64_t result;
+      do {
+        result = ::pread(req.fd, req.buf, req.len, static_cast<off_t>(req.offset));
+      } while (result < 0 && errno == EINTR);
+      if (result < 0) result = -errno;
+      {
+        std::lock_guard lock(mu_);
+        done_.push_back({req.tag, result});
+      }
+      done_cv_.notify_one();
+    }
+  }
+
+  std::mutex mu_;
+  std::condition_variable work_cv_, done_cv_;
+  std::deque<ReadRequest> work_;
+  std::deque<ReadCompletion> done_;
+  bool stop_ = false;
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace nway::detail
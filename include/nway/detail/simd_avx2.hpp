@@ -0,0 +1,96 @@
+#pragma once
+
+// AVX2 bitonic merge kernels. Compiled for AVX2 through a target region so
+// the rest of the program keeps the baseline instruction set; only called
+// after runtime detection.
+
+#include <immintrin.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "simd_common.hpp"
+
+NWAY_SIMD_TARGET_BEGIN("avx2")
+
+namespace nway::detail::avx2 {
+
+struct U32 {
+  using T = std::uint32_t;
+  using V = __m256i;
+  static constexpr std::size_t W = 8;
+
+  static V load(const T* p) { return _mm256_loadu_si256(reinterpret_cast<const V*>(p)); }
+  static void store(T* p, V v) { _mm256_storeu_si256(reinterpret_cast<V*>(p), v); }
+  static V reverse(V v) {
+    return _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+  }
+  static void minmax(V a, V b, V& lo, V& hi) {
+    lo = _mm256_min_epu32(a, b);
+    hi = _mm256_max_epu32(a, b);
+  }
+  static V bitonic_sort(V v) {
+    V lo, hi;
+    minmax(v, _mm256_permute2x128_si256(v, v, 1), lo, hi);
+    v = _mm256_blend_epi32(lo, hi, 0xF0);
+    minmax(v, _mm256_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)), lo, hi);
+    v = _mm256_blend_epi32(lo, hi, 0xCC);
+    minmax(v, _mm256_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)), lo, hi);
+    return _mm256_blend_epi32(lo, hi, 0xAA);
+  }
+};
+
+struct F32 {
+  using T = float;
+  using V = __m256;
+  static constexpr std::size_t W = 8;
+
+  static V load(const T* p) { return _mm256_loadu_ps(p); }
+  static void store(T* p, V v) { _mm256_storeu_ps(p, v); }
+  static V reverse(V v) {
+    return _mm256_permutevar8x32_ps(v, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+  }
+  static void minmax(V a, V b, V& lo, V& hi) {
+    lo = _mm256_min_ps(a, b);
+    hi = _mm256_max_ps(a, b);
+  }
+  static V bitonic_sort(V v) {
+    V lo, hi;
+    minmax(v, _mm256_permute2f128_ps(v, v, 1), lo, hi);
+    v = _mm256_blend_ps(lo, hi, 0xF0);
+    minmax(v, _mm256_permute_ps(v, _MM_SHUFFLE(1, 0, 3, 2)), lo, hi);
+    v = _mm256_blend_ps(lo, hi, 0xCC);
+    minmax(v, _mm256_permute_ps(v, _MM_SHUFFLE(2, 3, 0, 1)), lo, hi);
+    return _mm256_blend_ps(lo, hi, 0xAA);
+  }
+};
+
+// AVX2 has no unsigned 64-bit min/max: compare with the sign bit flipped.
+struct U64 {
+  using T = std::uint64_t;
+  using V = __m256i;
+  static constexpr std::size_t W = 4;
+
+  static V load(const T* p) { return _mm256_loadu_si256(reinterpret_cast<const V*>(p)); }
+  static void store(T* p, V v) { _mm256_storeu_si256(reinterpret_cast<V*>(p), v); }
+  static V reverse(V v) { return _mm256_permute4x64_epi64(v, _MM_SHUFFLE(0, 1, 2, 3)); }
+  static void minmax(V a, V b, V& lo, V& hi) {
+    const V bias = _mm256_set1_epi64x(INT64_MIN);
+    V gt = _mm256_cmpgt_epi64(_mm256_xor_si256(a, bias), _mm256_xor_si256(b, bias));
+    lo = _mm256_blendv_epi8(a, b, gt);
+    hi = _mm256_blendv_epi8(b, a, gt);
+  }
+  static V bitonic_sort(V v) {
+    V lo, hi;
+    minmax(v, _mm256_permute2x128_si256(v, v, 1), lo, hi);
+    v = _mm256_blend_epi32(lo, hi, 0xF0);
+    minmax(v, _mm256_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)), lo, hi);
+    return _mm256_blend_epi32(lo, hi, 0xCC);
+  }
+};
+
+#include "bitonic_driver.inc"
+
+}  // namespace nway::detail::avx2
+
+NWAY_SIMD_TARGET_END
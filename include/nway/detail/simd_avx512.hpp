@@ -0,0 +1,116 @@
+#pragma once
+
+// AVX-512F bitonic merge kernels; see simd_avx2.hpp. Each network level
+// exchanges lanes i and i ^ d with one permutexvar and a masked blend.
+
+#include <immintrin.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "simd_common.hpp"
+
+// GCC 12 flags the intrinsics' internal _mm512_undefined_* operands (PR105593).
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+NWAY_SIMD_TARGET_BEGIN("avx512f")
+
+namespace nway::detail::avx512 {
+
+struct U32 {
+  using T = std::uint32_t;
+  using V = __m512i;
+  static constexpr std::size_t W = 16;
+
+  static V load(const T* p) { return _mm512_loadu_si512(p); }
+  static void store(T* p, V v) { _mm512_storeu_si512(p, v); }
+  static V partner(V v, int d) {
+    const V iota = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    return _mm512_permutexvar_epi32(_mm512_xor_si512(iota, _mm512_set1_epi32(d)), v);
+  }
+  static V reverse(V v) { return partner(v, 15); }
+  static void minmax(V a, V b, V& lo, V& hi) {
+    lo = _mm512_min_epu32(a, b);
+    hi = _mm512_max_epu32(a, b);
+  }
+  static V bitonic_sort(V v) {
+    V lo, hi;
+    minmax(v, partner(v, 8), lo, hi);
+    v = _mm512_mask_blend_epi32(0xFF00, lo, hi);
+    minmax(v, partner(v, 4), lo, hi);
+    v = _mm512_mask_blend_epi32(0xF0F0, lo, hi);
+    minmax(v, partner(v, 2), lo, hi);
+    v = _mm512_mask_blend_epi32(0xCCCC, lo, hi);
+    minmax(v, partner(v, 1), lo, hi);
+    return _mm512_mask_blend_epi32(0xAAAA, lo, hi);
+  }
+};
+
+struct F32 {
+  using T = float;
+  using V = __m512;
+  static constexpr std::size_t W = 16;
+
+  static V load(const T* p) { return _mm512_loadu_ps(p); }
+  static void store(T* p, V v) { _mm512_storeu_ps(p, v); }
+  static V partner(V v, int d) {
+    const __m512i iota = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    return _mm512_permutexvar_ps(_mm512_xor_si512(iota, _mm512_set1_epi32(d)), v);
+  }
+  static V reverse(V v) { return partner(v, 15); }
+  static void minmax(V a, V b, V& lo, V& hi) {
+    lo = _mm512_min_ps(a, b);
+    hi = _mm512_max_ps(a, b);
+  }
+  static V bitonic_sort(V v) {
+    V lo, hi;
+    minmax(v, partner(v, 8), lo, hi);
+    v = _mm512_mask_blend_ps(0xFF00, lo, hi);
+    minmax(v, partner(v, 4), lo, hi);
+    v = _mm512_mask_blend_ps(0xF0F0, lo, hi);
+    minmax(v, partner(v, 2), lo, hi);
+    v = _mm512_mask_blend_ps(0xCCCC, lo, hi);
+    minmax(v, partner(v, 1), lo, hi);
+    return _mm512_mask_blend_ps(0xAAAA, lo, hi);
+  }
+};
+
+struct U64 {
+  using T = std::uint64_t;
+  using V = __m512i;
+  static constexpr std::size_t W = 8;
+
+  static V load(const T* p) { return _mm512_loadu_si512(p); }
+  static void store(T* p, V v) { _mm512_storeu_si512(p, v); }
+  static V partner(V v, int d) {
+    const V iota = _mm512_setr_epi64(0, 1, 2, 3, 4, 5, 6, 7);
+    return _mm512_permutexvar_epi64(_mm512_xor_si512(iota, _mm512_set1_epi64(d)), v);
+  }
+  static V reverse(V v) { return partner(v, 7); }
+  static void minmax(V a, V b, V& lo, V& hi) {
+    lo = _mm512_min_epu64(a, b);
+    hi = _mm512_max_epu64(a, b);
+  }
+  static V bitonic_sort(V v) {
+    V lo, hi;
+    minmax(v, partner(v, 4), lo, hi);
+    v = _mm512_mask_blend_epi64(0xF0, lo, hi);
+    minmax(v, partner(v, 2), lo, hi);
+    v = _mm512_mask_blend_epi64(0xCC, lo, hi);
+    minmax(v, partner(v, 1), lo, hi);
+    return _mm512_mask_blend_epi64(0xAA, lo, hi);
+  }
+};
+
+#include "bitonic_driver.inc"
+
+}  // namespace nway::detail::avx512
+
+NWAY_SIMD_TARGET_END
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+
+// Opens/closes a region whose functions are compiled for an extra instruction
+// set (GCC and Clang); used for the runtime-dispatched SIMD kernels.
+#if defined(__clang__)
+#define NWAY_SIMD_PRAGMA(x) _Pragma(#x)
+#define NWAY_SIMD_TARGET_BEGIN(isa) \
+  NWAY_SIMD_PRAGMA(clang attribute push(__attribute__((target(isa))), apply_to = function))
+#define NWAY_SIMD_TARGET_END _Pragma("clang attribute pop")
+#else
+#define NWAY_SIMD_PRAGMA(x) _Pragma(#x)
+#define NWAY_SIMD_TARGET_BEGIN(isa) \
+  _Pragma("GCC push_options") NWAY_SIMD_PRAGMA(GCC target(isa))
+#define NWAY_SIMD_TARGET_END _Pragma("GCC pop_options")
+#endif
+
+namespace nway::detail {
+
+/// Plain two-way merge used for short inputs and kernel tails. Takes from `a`
+/// on ties.
+template <class T>
+T* scalar_merge2(const T* a, std::size_t na, const T* b, std::size_t nb, T* out) {
+  std::size_t i = 0, j = 0;
+  while (i < na && j < nb) *out++ = b[j] < a[i] ? b[j++] : a[i++];
+  out = std::copy(a + i, a + na, out);
+  return std::copy(b + j, b + nb, out);
+}
+
+}  // namespace nway::detail
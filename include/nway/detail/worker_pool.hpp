@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "channel.hpp"
+
+namespace nway::detail {
+
+/// Fixed set of threads running submitted jobs in FIFO order. Jobs must not
+/// throw. The destructor runs the jobs already queued, then joins.
+class WorkerPool {
+ public:
+  explicit WorkerPool(std::size_t threads) {
+    workers_.reserve(threads);
+    for (std::size_t i = 0; i < threads; ++i)
+      workers_.emplace_back([this] {
+        std::function<void()> job;
+        while (jobs_.pop(job)) job();
+      });
+  }
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
+  ~WorkerPool() {
+    jobs_.close();
+    for (auto& t : workers_) t.join();
+  }
+
+  void submit(std::function<void()> job) { jobs_.push(std::move(job)); }
+
+ private:
+  Channel<std::function<void()>> jobs_;
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace nway::detail
@@ -0,0 +1,751 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <exception>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "async_run.hpp"
+#include "compressed_run.hpp"
+#include "detail/channel.hpp"
+#include "detail/file.hpp"
+#include "forecast_run.hpp"
+#include "loser_tree.hpp"
+#include "merge_plan.hpp"
+#include "mmap_run.hpp"
+#include "packed_run.hpp"
+#include "parallel_sort.hpp"
+#include "run_file.hpp"
+
+namespace nway {
+
+/// How merge passes read their input runs.
+enum class RunIo {
+  read,      // RunReader: buffered read() into one buffer per run
+  mmap,      // MappedRunReader: mmap with madvise readahead; read_buffer is the window
+  async,     // AsyncRunSet: io_uring (or thread-pool pread) into two buffers per run
+  forecast,  // ForecastRunSet: one buffer per run plus a shared prefetch pool
+};
+
+/// How phase 1 of external_sort() forms the initial runs.
+enum class RunFormation {
+  chunk_sort,             // sort memory-sized chunks (overlap_io, sort_threads apply)
+  replacement_selection,  // stream through a loser tree; ~2x longer runs on random input
+};
+
+/// How spilled runs (phase 1 and intermediate merges) and the final output
+/// are stored.
+enum class SpillFormat {
+  raw,         // records as they are in memory, read as opts.run_io says
+  packed,      // 32/64-bit unsigned keys, delta + bit packed (packed_run.hpp)
+  compressed,  // blocks of write_buffer bytes, default_block_codec() (compressed_run.hpp)
+};
+
+/// Order of the merges in phase 2 of external_sort(); see merge_plan.hpp.
+enum class MergeSchedule {
+  arrival,  // level by level, runs grouped in the order they were formed
+  huffman,  // smallest runs first, so the largest are read only once
+};
+
+/// Knobs for external_sort(). `memory_limit` bounds every buffer the sort
+/// allocates (sort chunk, read buffers, tree, write buffer); the process's own
+/// baseline footprint comes on top of it.
+struct ExternalSortOptions {
+  std::size_t memory_limit = std::size_t(256) << 20;
+  std::size_t read_buffer = std::size_t(1) << 20;   // per input run while merging
+  std::size_t write_buffer = std::size_t(1) << 20;  // merge output
+  std::filesystem::path temp_dir;                   // empty: system temp directory
+  RunIo run_io = RunIo::read;
+  SpillFormat spill_format = SpillFormat::raw;
+  SpillFormat output_format = SpillFormat::raw;
+  RunFormation run_formation = RunFormation::chunk_sort;
+  MergeSchedule merge_schedule = MergeSchedule::huffman;
+  std::size_t sort_threads = 0;  // run generation (chunk_sort): 0 = all cores
+  bool overlap_io = false;       // run generation: read, sort and write chunks concurrently
+};
+
+struct ExternalSortStats {
+  std::uint64_t records = 0;
+  std::size_t initial_runs = 0;
+  std::size_t merge_passes = 0;
+  std::size_t fan_in = 0;
+  std::uint64_t bytes_read = 0;
+  std::uint64_t bytes_written = 0;
+  // Phase 1: time each stage spent working (not waiting on the others) and
+  // the phase's wall time. Every stage moves the whole input, so
+  // records * sizeof(T) / seconds is that stage's throughput. Replacement
+  // selection interleaves the stages per record and only reports wall time.
+  double read_seconds = 0;
+  double sort_seconds = 0;
+  double write_seconds = 0;
+  double run_generation_seconds = 0;
+  // Phase 2: bytes of input runs per merge pass, as planned from the run
+  // sizes and as the readers actually fetched them.
+  std::vector<std::uint64_t> predicted_pass_bytes;
+  std::vector<std::uint64_t> pass_bytes_read;
+};
+
+/// Largest number of runs one merge pass can hold open within the budget.
+template <class T>
+std::size_t external_fan_in(const ExternalSortOptions& opts) {
+  // Each open run costs its read buffer (two when mapped or double-buffered),
+  // a key in the tree and a few words of bookkeeping (tree node, reader).
+  std::size_t available = opts.memory_limit - std::min(opts.memory_limit, opts.write_buffer);
+  std::size_t per_run = opts.read_buffer + sizeof(T) + 64;
+  switch (opts.run_io) {
+    case RunIo::read:
+      break;
+    case RunIo::mmap:
+    case RunIo::async:
+      per_run += opts.read_buffer;
+      break;
+    case RunIo::forecast:
+      // Pool of max(2, K/8) buffers, see ForecastRunSet::default_prefetch_buffers.
+      available -= std::min(available, 2 * opts.read_buffer);
+      per_run += opts.read_buffer / 8;
+      break;
+  }
+  if (opts.spill_format == SpillFormat::packed)
+    per_run += detail::kPackedBlock * sizeof(T);  // a decoded block per open run
+  if (opts.spill_format == SpillFormat::compressed) {
+    // kCompressedAhead slots per run instead of the read buffer, each a
+    // decoded block (write_buffer bytes), plus its compressed image when a
+    // codec is built in.
+    const std::size_t images = default_block_codec() == BlockCodec::none ? 1 : 2;
+    per_run = images * kCompressedAhead * opts.write_buffer + sizeof(T) + 64;
+  }
+  if (opts.spill_format == SpillFormat::compressed || opts.output_format == SpillFormat::compressed)
+    available -= std::min(available, opts.write_buffer);  // the writer's compressed image
+  if (opts.spill_format == SpillFormat::packed || opts.output_format == SpillFormat::packed)
+    available -= std::min(available, detail::kPackedBlock * sizeof(T));  // block being encoded
+  return available / per_run;
+}
+
+namespace detail {
+
+// Merges cursors with the RunReader interface (empty/front/pop) into `writer`;
+// returns the number of records written.
+template <class Cursor, class Writer, class Compare>
+std::uint64_t merge_cursors(std::vector<Cursor>& cursors, Writer& writer, Compare& comp) {
+  using T = std::remove_cvref_t<decltype(cursors[0].front())>;
+  LoserTree<T, Compare> tree(comp);
+  tree.reset(cursors.size());
+  for (std::size_t i = 0; i < cursors.size(); ++i)
+    if (!cursors[i].empty()) tree.set(i, cursors[i].front());
+  tree.build();
+
+  std::uint64_t records = 0;
+  for (; !tree.empty(); ++records) {
+    auto& c = cursors[tree.top_leaf()];
+    writer.push(tree.top());
+    c.pop();
+    if (!c.empty())
+      tree.replace_top(c.front());
+    else
+      tree.retire_top();
+  }
+  return records;
+}
+
+}  // namespace detail
+
+/// Merges the sorted run files `inputs` into `output`. `Reader` is
+/// RunReader, MappedRunReader, AsyncRunSet, ForecastRunSet, PackedRunReader
+/// or CompressedRunSet; `Writer` is RunWriter, PackedRunWriter or
+/// CompressedRunWriter. Returns the number of records merged; `stats` gets
+/// the bytes the readers fetched (their bytes_read()) and the bytes written.
+template <class T, class Reader = RunReader<T>, class Compare = std::less<>,
+          class Writer = RunWriter<T>>
+std::uint64_t merge_run_files(const std::vector<std::filesystem::path>& inputs,
+                              const std::filesystem::path& output, std::size_t read_buffer,
+                              std::size_t write_buffer, Compare comp = Compare(),
+                              ExternalSortStats* stats = nullptr) {
+  Writer writer(output, write_buffer);
+  std::uint64_t records = 0, bytes_read = 0;
+  if constexpr (std::is_same_v<Reader, AsyncRunSet<T>>) {
+    AsyncRunSet<T> set(inputs, read_buffer);
+    records = detail::merge_cursors(set.cursors(), writer, comp);
+    bytes_read = set.bytes_read();
+  } else if constexpr (std::is_same_v<Reader, ForecastRunSet<T>>) {
+    ForecastRunSet<T> set(inputs, read_buffer, 0, comp);
+    records = detail::merge_cursors(set.cursors(), writer, comp);
+    bytes_read = set.bytes_read();
+  } else if constexpr (std::is_same_v<Reader, CompressedRunSet<T>>) {
+    CompressedRunSet<T> set(inputs);
+    records = detail::merge_cursors(set.cursors(), writer, comp);
+    bytes_read = set.bytes_read();
+  } else {
+    std::vector<Reader> readers;
+    readers.reserve(inputs.size());
+    for (const auto& p : inputs) readers.emplace_back(p, read_buffer);
+    records = detail::merge_cursors(readers, writer, comp);
+    for (const auto& r : readers) bytes_read += r.bytes_read();
+  }
+  writer.finish();
+
+  if (stats) {
+    stats->bytes_read += bytes_read;
+    stats->bytes_written += writer.bytes_written();
+  }
+  return records;
+}
+
+namespace detail {
+
+using Clock = std::chrono::steady_clock;
+
+inline double seconds_since(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Number of records in `in`; also counts the whole input as read.
+template <class T>
+std::uint64_t input_records(const File& in, ExternalSortStats& stats) {
+  if (in.size() % sizeof(T) != 0)
+    throw std::runtime_error("input size is not a multiple of the record size");
+  stats.records = in.size() / sizeof(T);
+  stats.bytes_read += in.size();
+  return stats.records;
+}
+
+// Calls f(writer) with a writer of `format` for `path`.
+template <class T, class F>
+void with_writer(SpillFormat format, const std::filesystem::path& path, std::size_t buffer, F&& f) {
+  if constexpr (is_packed_key_v<T>) {
+    if (format == SpillFormat::packed) {
+      PackedRunWriter<T> w(path, buffer);
+      return f(w);
+    }
+  }
+  if (format == SpillFormat::compressed) {
+    CompressedRunWriter<T> w(path, buffer);
+    return f(w);
+  }
+  RunWriter<T> w(path, buffer);
+  f(w);
+}
+
+// Bytes the writer with_writer() picks for `format` holds.
+template <class T>
+std::size_t writer_footprint(SpillFormat format, std::size_t buffer) {
+  if constexpr (is_packed_key_v<T>) {
+    if (format == SpillFormat::packed) return PackedRunWriter<T>::footprint(buffer);
+  }
+  if (format == SpillFormat::compressed) return CompressedRunWriter<T>::footprint(buffer);
+  return RunWriter<T>::footprint(buffer);
+}
+
+// Cursor over a sorted span, for merge_cursors().
+template <class T>
+struct SpanCursor {
+  const T* pos;
+  const T* end;
+
+  bool empty() const { return pos == end; }
+  const T& front() const { return *pos; }
+  void pop() { ++pos; }
+};
+
+// Where and how a whole run is written: spills in opts.spill_format, the
+// final output in opts.output_format.
+template <class T>
+struct Spill {
+  SpillFormat format = SpillFormat::raw;
+  std::size_t buffer = 0;  // encode buffer / compressed block size
+
+  // Writes a whole run; returns the bytes written.
+  std::uint64_t write(const std::filesystem::path& path, const T* data, std::size_t n) const {
+    if (format == SpillFormat::raw) {
+      File out = File::create(path);
+      out.write(data, n * sizeof(T));
+      return n * sizeof(T);
+    }
+    std::uint64_t bytes = 0;
+    with_writer<T>(format, path, buffer, [&](auto& w) {
+      w.write(data, n);
+      w.finish();
+      bytes = w.bytes_written();
+    });
+    return bytes;
+  }
+
+  // Writes the merge of the sorted `pieces` as one run, streaming it through
+  // a writer so the pieces need no merge buffer; returns the bytes written.
+  template <class Compare>
+  std::uint64_t write_merged(const std::filesystem::path& path,
+                             const std::vector<std::span<const T>>& pieces, Compare& comp) const {
+    if (pieces.size() == 1) return write(path, pieces[0].data(), pieces[0].size());
+    std::vector<SpanCursor<T>> cursors;
+    for (const auto& p : pieces) cursors.push_back({p.data(), p.data() + p.size()});
+    std::uint64_t bytes = 0;
+    with_writer<T>(format, path, buffer, [&](auto& w) {
+      merge_cursors(cursors, w, comp);
+      w.finish();
+      bytes = w.bytes_written();
+    });
+    return bytes;
+  }
+
+  // Bytes write() (`pieces` == 1) or write_merged() allocates on top of the
+  // records it is given.
+  std::size_t footprint(std::size_t pieces = 1) const {
+    return format == SpillFormat::raw && pieces <= 1 ? 0 : writer_footprint<T>(format, buffer);
+  }
+};
+
+template <class T>
+Spill<T> spill_as(SpillFormat format, const ExternalSortOptions& opts) {
+  if (format == SpillFormat::packed && !is_packed_key_v<T>)
+    throw std::invalid_argument("the packed format needs 32- or 64-bit unsigned keys");
+  return {format, opts.write_buffer};
+}
+
+// Number of records in the run `path` of `format`. Encoded runs are decoded
+// to count them.
+template <class T>
+std::uint64_t run_records(const std::filesystem::path& path, SpillFormat format,
+                          std::size_t read_buffer) {
+  std::uint64_t records = 0;
+  auto count = [&](auto& cursor) {
+    for (; !cursor.empty(); cursor.pop()) ++records;
+  };
+  if constexpr (is_packed_key_v<T>) {
+    if (format == SpillFormat::packed) {
+      PackedRunReader<T> reader(path, read_buffer);
+      count(reader);
+      return records;
+    }
+  }
+  if (format == SpillFormat::compressed) {
+    CompressedRunSet<T> set({path});
+    count(set.cursors()[0]);
+    return records;
+  }
+  return std::filesystem::file_size(path) / sizeof(T);
+}
+
+// Merges `inputs` into `out` with reader `Reader`, writing `format`; returns
+// the number of records.
+template <class T, class Reader, class Compare>
+std::uint64_t merge_into_format(const std::vector<std::filesystem::path>& inputs,
+                                const std::filesystem::path& out, const ExternalSortOptions& opts,
+                                Compare& comp, ExternalSortStats& stats, SpillFormat format) {
+  switch (format) {
+    case SpillFormat::packed:
+      if constexpr (is_packed_key_v<T>) {
+        return merge_run_files<T, Reader, Compare, PackedRunWriter<T>>(
+            inputs, out, opts.read_buffer, opts.write_buffer, comp, &stats);
+      }
+      break;
+    case SpillFormat::compressed:
+      return merge_run_files<T, Reader, Compare, CompressedRunWriter<T>>(
+          inputs, out, opts.read_buffer, opts.write_buffer, comp, &stats);
+    case SpillFormat::raw:
+      return merge_run_files<T, Reader, Compare, RunWriter<T>>(inputs, out, opts.read_buffer,
+                                                               opts.write_buffer, comp, &stats);
+  }
+  throw std::invalid_argument("the packed format needs 32- or 64-bit unsigned keys");
+}
+
+// Merges spilled runs `inputs` into `out`: read in opts.spill_format (raw
+// spills with the reader opts.run_io selects), written as a spill, or in
+// opts.output_format when `last`. Returns the number of records.
+template <class T, class Compare>
+std::uint64_t merge_group(const std::vector<std::filesystem::path>& inputs,
+                          const std::filesystem::path& out, const ExternalSortOptions& opts,
+                          Compare& comp, ExternalSortStats& stats, bool last) {
+  const SpillFormat format = last ? opts.output_format : opts.spill_format;
+  switch (opts.spill_format) {
+    case SpillFormat::packed:
+      if constexpr (is_packed_key_v<T>) {
+        return merge_into_format<T, PackedRunReader<T>>(inputs, out, opts, comp, stats, format);
+      }
+      break;
+    case SpillFormat::compressed:
+      return merge_into_format<T, CompressedRunSet<T>>(inputs, out, opts, comp, stats, format);
+    case SpillFormat::raw:
+      switch (opts.run_io) {
+        case RunIo::read:
+          return merge_into_format<T, RunReader<T>>(inputs, out, opts, comp, stats, format);
+        case RunIo::mmap:
+          return merge_into_format<T, MappedRunReader<T>>(inputs, out, opts, comp, stats, format);
+        case RunIo::async:
+          return merge_into_format<T, AsyncRunSet<T>>(inputs, out, opts, comp, stats, format);
+        case RunIo::forecast:
+          return merge_into_format<T, ForecastRunSet<T>>(inputs, out, opts, comp, stats, format);
+      }
+  }
+  throw std::invalid_argument("the packed format needs 32- or 64-bit unsigned keys");
+}
+
+// Phase 1: cuts the input into memory-sized chunks, sorts each and spills it.
+// Writes straight to `output` when everything fits in one chunk. With
+// `threads > 1` a chunk is sorted as one piece per thread
+// (parallel_sort_pieces()) and the pieces are merged on the way to the disk,
+// so the whole chunk still fits the budget; that merge counts as writing.
+template <class T, class Compare>
+std::vector<std::filesystem::path> generate_runs(File& in, const std::filesystem::path& output,
+                                                 std::size_t chunk_elems, std::size_t threads,
+                                                 const Spill<T>& spill, const Spill<T>& final,
+                                                 TempDir& tmp, Compare& comp,
+                                                 ExternalSortStats& stats) {
+  const std::uint64_t total = input_records<T>(in, stats);
+  const std::size_t cap = static_cast<std::size_t>(std::min<std::uint64_t>(chunk_elems, total));
+  std::unique_ptr<T[]> chunk(new T[std::max<std::size_t>(cap, 1)]);
+  std::vector<std::filesystem::path> runs;
+  for (std::uint64_t done = 0; done < total || runs.empty();) {
+    auto start = Clock::now();
+    std::size_t n = in.read(chunk.get(), cap * sizeof(T)) / sizeof(T);
+    done += n;
+    stats.read_seconds += seconds_since(start);
+    start = Clock::now();
+    const auto pieces = parallel_sort_pieces(std::span<T>(chunk.get(), n), threads, comp);
+    stats.sort_seconds += seconds_since(start);
+    start = Clock::now();
+    const bool only = runs.empty() && done == total;
+    runs.push_back(only ? output : tmp.next_file());
+    stats.bytes_written += (only ? final : spill).write_merged(runs.back(), pieces, comp);
+    stats.write_seconds += seconds_since(start);
+    if (only) break;
+  }
+  stats.initial_runs = runs.size();
+  return runs;
+}
+
+// Chunk buffers that circulate between the pipelined stages: one being read,
+// one being sorted, one being written.
+inline constexpr std::size_t kStageBuffers = 3;
+
+// Phase 1 as a pipeline: a reader thread fills chunk buffers, the calling
+// thread sorts them with parallel_sort() on `threads` workers and a writer
+// thread spills them, so the disk and the cores are busy at the same time.
+// The sorter keeps one extra buffer as merge scratch when `threads > 1`.
+// Same runs, in the same order, as generate_runs() with `chunk_elems`.
+template <class T, class Compare>
+std::vector<std::filesystem::path> generate_runs_pipelined(File& in,
+                                                           const std::filesystem::path& output,
+                                                           std::size_t chunk_elems,
+                                                           std::size_t threads,
+                                                           const Spill<T>& spill,
+                                                           const Spill<T>& final, TempDir& tmp,
+                                                           Compare& comp, ExternalSortStats& stats) {
+  const std::uint64_t total = input_records<T>(in, stats);
+  const std::size_t cap = std::max<std::size_t>(
+      static_cast<std::size_t>(std::min<std::uint64_t>(chunk_elems, total)), 1);
+  std::vector<std::unique_ptr<T[]>> buffers;
+  for (std::size_t b = 0; b < kStageBuffers + (threads > 1); ++b) buffers.emplace_back(new T[cap]);
+
+  struct Chunk {
+    std::size_t buffer = 0;
+    std::size_t n = 0;
+    bool only = false;  // the whole input: goes straight to `output`
+  };
+  Channel<std::size_t> free;
+  Channel<Chunk> filled, sorted;
+  for (std::size_t b = 0; b < kStageBuffers; ++b) free.push(b);
+  std::atomic<bool> failed{false};
+  std::exception_ptr errors[3];
+  auto fail = [&](std::exception_ptr& slot) {
+    slot = std::current_exception();
+    failed = true;
+    free.close();
+    filled.close();
+    sorted.close();
+  };
+  std::vector<std::filesystem::path> runs;
+
+  std::thread reader([&] {
+    try {
+      std::uint64_t done = 0;
+      std::size_t b;
+      for (bool first = true; (done < total || first) && !failed && free.pop(b); first = false) {
+        const auto start = Clock::now();
+        const std::size_t n = in.read(buffers[b].get(), cap * sizeof(T)) / sizeof(T);
+        done += n;
+        stats.read_seconds += seconds_since(start);
+        filled.push({b, n, first && done == total});
+      }
+      filled.close();
+    } catch (...) {
+      fail(errors[0]);
+    }
+  });
+  std::thread writer([&] {
+    try {
+      Chunk c;
+      while (!failed && sorted.pop(c)) {
+        const auto start = Clock::now();
+        runs.push_back(c.only ? output : tmp.next_file());
+        stats.bytes_written +=
+            (c.only ? final : spill).write(runs.back(), buffers[c.buffer].get(), c.n);
+        stats.write_seconds += seconds_since(start);
+        free.push(c.buffer);
+      }
+    } catch (...) {
+      fail(errors[2]);
+    }
+  });
+  try {
+    std::size_t spare = kStageBuffers;
+    Chunk c;
+    while (!failed && filled.pop(c)) {
+      const auto start = Clock::now();
+      const std::span<T> data(buffers[c.buffer].get(), c.n);
+      if (threads > 1) {
+        const std::span<T> result =
+            parallel_sort(data, std::span<T>(buffers[spare].get(), cap), threads, comp);
+        if (result.data() != data.data()) std::swap(c.buffer, spare);
+      } else {
+        std::sort(data.begin(), data.end(), comp);
+      }
+      stats.sort_seconds += seconds_since(start);
+      sorted.push(c);
+    }
+    sorted.close();
+  } catch (...) {
+    fail(errors[1]);
+  }
+  reader.join();
+  writer.join();
+  for (const auto& e : errors)
+    if (e) std::rethrow_exception(e);
+  stats.initial_runs = runs.size();
+  return runs;
+}
+
+// Loser tree leaves replacement selection can hold within `opts`: the budget
+// minus the input buffer and the spill writer, at one key, one tree node and
+// two flag bytes per leaf.
+template <class T>
+std::size_t replacement_selection_leaves(const ExternalSortOptions& opts) {
+  const std::size_t buffers =
+      opts.read_buffer + writer_footprint<T>(opts.spill_format, opts.write_buffer);
+  const std::size_t available = opts.memory_limit - std::min(opts.memory_limit, buffers);
+  return std::max<std::size_t>(available / (sizeof(T) + sizeof(typename LoserTree<T>::Index) + 2), 1);
+}
+
+// Phase 1 by replacement selection over a loser tree of
+// replacement_selection_leaves<T>(opts) keys. The
+// winner is appended to the current run and its leaf refilled from the
+// input; a record smaller than the one just written cannot extend the run,
+// so its leaf is deferred to the next one. A run ends when every leaf is
+// deferred (or exhausted). Random input gives runs of about twice the leaves,
+// sorted input a single run.
+template <class T, class Compare>
+std::vector<std::filesystem::path> replacement_selection_runs(File& in,
+                                                              const std::filesystem::path& output,
+                                                              const ExternalSortOptions& opts,
+                                                              TempDir& tmp, Compare& comp,
+                                                              ExternalSortStats& stats) {
+  const std::uint64_t total = input_records<T>(in, stats);
+  const std::size_t leaves = replacement_selection_leaves<T>(opts);
+  const std::size_t cap = std::max<std::size_t>(1, opts.read_buffer / sizeof(T));
+  std::unique_ptr<T[]> buf(new T[cap]);
+  std::size_t pos = 0, len = 0;
+  auto next = [&](T& x) {
+    if (pos == len) {
+      len = in.read(buf.get(), cap * sizeof(T)) / sizeof(T);
+      pos = 0;
+      if (len == 0) return false;
+    }
+    x = buf[pos++];
+    return true;
+  };
+
+  LoserTree<T, Compare> tree(comp);
+  tree.reset(static_cast<std::size_t>(std::clamp<std::uint64_t>(total, 1, leaves)));
+  T x;
+  for (std::size_t i = 0; i < tree.size() && next(x); ++i) tree.set(i, x);
+  tree.revive();
+
+  auto form_run = [&](auto& writer) {
+    while (!tree.empty()) {
+      const T top = tree.top();
+      writer.push(top);
+      if (!next(x))
+        tree.retire_top();
+      else if (comp(x, top))
+        tree.defer_top(x);
+      else
+        tree.replace_top(x);
+    }
+    writer.finish();
+    stats.bytes_written += writer.bytes_written();
+  };
+  std::vector<std::filesystem::path> runs;
+  while (!tree.empty()) {
+    runs.push_back(tmp.next_file());
+    with_writer<T>(opts.spill_format, runs.back(), opts.write_buffer, form_run);
+    tree.revive();
+  }
+  if (runs.size() <= 1) {
+    // Everything fit in one run: it is the output, after conversion if the
+    // formats differ. Copy when the temp directory is on another file system.
+    if (runs.empty()) {
+      spill_as<T>(opts.output_format, opts).write(output, nullptr, 0);
+    } else if (opts.spill_format != opts.output_format) {
+      merge_group<T>(runs, output, opts, comp, stats, true);
+    } else {
+      std::error_code ec;
+      std::filesystem::rename(runs[0], output, ec);
+      if (ec)
+        std::filesystem::copy_file(runs[0], output,
+                                   std::filesystem::copy_options::overwrite_existing);
+    }
+    runs = {output};
+  }
+  stats.initial_runs = runs.size();
+  return runs;
+}
+
+// Phase 2: plans the merges of `runs` (at least two) by opts.merge_schedule
+// and runs them, the last one into `output`. Intermediate runs are deleted
+// once merged, the initial ones too when `remove_inputs` is set. Returns the
+// number of records in `output`.
+template <class T, class Compare>
+std::uint64_t merge_planned(std::vector<std::filesystem::path> runs,
+                            const std::filesystem::path& output, const ExternalSortOptions& opts,
+                            TempDir& tmp, Compare& comp, ExternalSortStats& stats,
+                            bool remove_inputs) {
+  std::vector<std::uint64_t> sizes;
+  for (const auto& p : runs) sizes.push_back(std::filesystem::file_size(p));
+  const MergePlan plan = opts.merge_schedule == MergeSchedule::huffman
+                             ? plan_huffman_merges(sizes, stats.fan_in)
+                             : plan_arrival_merges(sizes, stats.fan_in);
+  stats.predicted_pass_bytes = plan.pass_bytes;
+  stats.pass_bytes_read.assign(plan.passes(), 0);
+  stats.merge_passes = plan.passes();
+
+  const std::size_t initial = runs.size();
+  std::uint64_t records = 0;
+  for (std::size_t j = 0; j < plan.steps.size(); ++j) {
+    const MergeStep& step = plan.steps[j];
+    std::vector<std::filesystem::path> group;
+    for (std::size_t id : step.inputs) group.push_back(runs[id]);
+    const bool last = j + 1 == plan.steps.size();
+    runs.push_back(last ? output : tmp.next_file());
+    const std::uint64_t before = stats.bytes_read;
+    records = merge_group<T>(group, runs.back(), opts, comp, stats, last);
+    stats.pass_bytes_read[step.pass - 1] += stats.bytes_read - before;
+    for (std::size_t id : step.inputs)
+      if (id >= initial || remove_inputs) std::filesystem::remove(runs[id]);
+  }
+  return records;
+}
+
+}  // namespace detail
+
+/// Sorts a file of raw `T` records into `output` using at most
+/// `opts.memory_limit` bytes of working memory.
+///
+/// Phase 1 forms sorted runs, by default (RunFormation::chunk_sort) by
+/// sorting memory-sized chunks and spilling them. With `opts.overlap_io` it
+/// is a pipeline: the next chunk is read and the previous one written while
+/// the current one is sorted on `opts.sort_threads` cores, at the price of a
+/// third (one sort thread) or a quarter (several) of the budget per chunk.
+/// Otherwise one chunk fills the budget and the stages take turns: the chunk
+/// is sorted as one piece per sort thread and the pieces are merged into the
+/// spill writer, so no merge buffer is needed. Either way the buffers of a
+/// packed or compressed spill writer come out of the budget before it is cut
+/// into chunks. RunFormation::replacement_selection streams the input through
+/// a loser tree instead, which roughly doubles the run length on random input
+/// and gives a single run on sorted input, so fewer merge passes follow.
+/// Phase 2 merges up to external_fan_in<T>(opts) runs at a time with a loser
+/// tree, in the order opts.merge_schedule plans from the run sizes
+/// (external_merge()). With SpillFormat::packed every spilled run is written
+/// by PackedRunWriter and read back by PackedRunReader; with
+/// SpillFormat::compressed by CompressedRunWriter and a CompressedRunSet,
+/// whose worker pool decompresses ahead of the merge (opts.run_io applies to
+/// raw spills only). Either trades CPU work for fewer bytes on disk.
+/// opts.output_format picks the output's format the same way.
+template <class T, class Compare = std::less<>>
+ExternalSortStats external_sort(const std::filesystem::path& input,
+                                const std::filesystem::path& output,
+                                const ExternalSortOptions& opts = {}, Compare comp = Compare()) {
+  static_assert(std::is_trivially_copyable_v<T>, "records must be trivially copyable");
+  ExternalSortStats stats;
+  stats.fan_in = external_fan_in<T>(opts);
+  if (stats.fan_in < 2 || opts.memory_limit < sizeof(T))
+    throw std::invalid_argument("memory_limit too small for two read buffers and a write buffer");
+
+  const auto spill = detail::spill_as<T>(opts.spill_format, opts);
+  const auto final = detail::spill_as<T>(opts.output_format, opts);
+
+  TempDir tmp(opts.temp_dir);
+  std::vector<std::filesystem::path> runs;
+  {
+    const auto start = detail::Clock::now();
+    detail::File in = detail::File::open_read(input);
+    if (opts.run_formation == RunFormation::replacement_selection) {
+      runs = detail::replacement_selection_runs<T>(in, output, opts, tmp, comp, stats);
+    } else {
+      const std::size_t threads = opts.sort_threads != 0
+                                      ? opts.sort_threads
+                                      : std::max(1u, std::thread::hardware_concurrency());
+      // Chunks share the budget with the writer an encoded or merged spill
+      // goes through.
+      const std::size_t pieces = opts.overlap_io ? 1 : threads;
+      const std::size_t writer = std::max(spill.footprint(pieces), final.footprint(pieces));
+      const std::size_t chunk_bytes = opts.memory_limit - std::min(opts.memory_limit, writer);
+      if (chunk_bytes < sizeof(T))
+        throw std::invalid_argument("memory_limit too small for a sort chunk and the spill writer");
+      if (opts.overlap_io) {
+        const std::size_t buffers = detail::kStageBuffers + (threads > 1);
+        runs = detail::generate_runs_pipelined<T>(in, output, chunk_bytes / (buffers * sizeof(T)),
+                                                  threads, spill, final, tmp, comp, stats);
+      } else {
+        runs = detail::generate_runs<T>(in, output, chunk_bytes / sizeof(T), threads, spill, final,
+                                        tmp, comp, stats);
+      }
+    }
+    stats.run_generation_seconds = detail::seconds_since(start);
+  }
+  if (runs.size() > 1)
+    detail::merge_planned<T>(std::move(runs), output, opts, tmp, comp, stats, true);
+  return stats;
+}
+
+/// Phase 2 of external_sort() on its own: merges the sorted run files `runs`
+/// into `output`, up to external_fan_in<T>(opts) at a time, in the order
+/// opts.merge_schedule plans from their sizes (plan_huffman_merges() by
+/// default). The runs are in opts.spill_format, the output is written in
+/// opts.output_format. The inputs are left in place; intermediate runs go to a scratch
+/// directory under opts.temp_dir. The stats compare the planned bytes per
+/// pass with those actually read.
+template <class T, class Compare = std::less<>>
+ExternalSortStats external_merge(const std::vector<std::filesystem::path>& runs,
+                                 const std::filesystem::path& output,
+                                 const ExternalSortOptions& opts = {}, Compare comp = Compare()) {
+  static_assert(std::is_trivially_copyable_v<T>, "records must be trivially copyable");
+  ExternalSortStats stats;
+  stats.fan_in = external_fan_in<T>(opts);
+  if (stats.fan_in < 2)
+    throw std::invalid_argument("memory_limit too small for two read buffers and a write buffer");
+  detail::spill_as<T>(opts.spill_format, opts);
+  stats.initial_runs = runs.size();
+  if (runs.empty()) {
+    detail::spill_as<T>(opts.output_format, opts).write(output, nullptr, 0);
+  } else if (runs.size() == 1 && opts.spill_format == opts.output_format) {
+    std::filesystem::copy_file(runs[0], output, std::filesystem::copy_options::overwrite_existing);
+    stats.records = detail::run_records<T>(output, opts.output_format, opts.read_buffer);
+  } else if (runs.size() == 1) {
+    stats.records = detail::merge_group<T>(runs, output, opts, comp, stats, true);
+  } else {
+    TempDir tmp(opts.temp_dir);
+    stats.records = detail::merge_planned<T>(runs, output, opts, tmp, comp, stats, false);
+  }
+  return stats;
+}
+
+}  // namespace nway
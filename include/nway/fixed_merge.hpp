@@ -0,0 +1,122 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <ranges>
+#include <stdexcept>
+
+#include "run.hpp"
+
+namespace nway {
+
+/// Largest K handled by the unrolled fixed-K merge when K is only known at
+/// run time.
+inline constexpr std::size_t kFixedMaxK = 8;
+
+namespace detail {
+
+// Index of the smallest head in [Lo, Hi), unrolled at compile time into a
+// balanced selection network. Ties go to the lower index; every step is an
+// index select, which compiles to a conditional move.
+template <std::size_t Lo, std::size_t Hi, class T, std::size_t K, class Compare>
+inline std::size_t select_min(const std::array<T, K>& head, Compare& comp) {
+  if constexpr (Hi - Lo == 1) {
+    return Lo;
+  } else {
+    constexpr std::size_t Mid = Lo + (Hi - Lo) / 2;
+    const std::size_t a = select_min<Lo, Mid>(head, comp);
+    const std::size_t b = select_min<Mid, Hi>(head, comp);
+    return comp(head[b], head[a]) ? b : a;
+  }
+}
+
+// Merges exactly K non-empty runs given as iterator pairs. When a run runs
+// out it is dropped and the rest continue in the K-1 specialization, so the
+// loop never checks exhausted inputs.
+template <std::size_t K, class It, class OutputIt, class Compare>
+OutputIt fixed_merge_live(std::array<It, K>& cur, std::array<It, K>& end, OutputIt out,
+                          Compare& comp) {
+  if constexpr (K == 1) {
+    return std::copy(cur[0], end[0], out);
+  } else {
+    using T = std::iter_value_t<It>;
+    std::array<T, K> head;
+    for (std::size_t i = 0; i < K; ++i) head[i] = *cur[i];
+    std::size_t w;
+    for (;;) {
+      w = select_min<0, K>(head, comp);
+      *out++ = head[w];
+      if (++cur[w] == end[w]) break;
+      head[w] = *cur[w];
+    }
+    std::array<It, K - 1> cur2, end2;
+    for (std::size_t i = 0, j = 0; i < K; ++i) {
+      if (i == w) continue;
+      cur2[j] = cur[i];
+      end2[j++] = end[i];
+    }
+    return fixed_merge_live<K - 1>(cur2, end2, out, comp);
+  }
+}
+
+// Entry with `n` <= K non-empty runs compacted to the front.
+template <std::size_t K, class It, class OutputIt, class Compare>
+OutputIt fixed_merge_n(std::array<It, K>& cur, std::array<It, K>& end, std::size_t n,
+                       OutputIt out, Compare& comp) {
+  if constexpr (K == 0) {
+    return out;
+  } else {
+    if (n == K) return fixed_merge_live<K>(cur, end, out, comp);
+    std::array<It, K - 1> cur2, end2;
+    std::copy_n(cur.begin(), K - 1, cur2.begin());
+    std::copy_n(end.begin(), K - 1, end2.begin());
+    return fixed_merge_n<K - 1>(cur2, end2, n, out, comp);
+  }
+}
+
+template <std::size_t K, RunRange Runs, class OutputIt, class Compare>
+OutputIt fixed_merge(const Runs& runs, OutputIt out, Compare& comp) {
+  using It = std::ranges::iterator_t<const std::ranges::range_value_t<Runs>>;
+  std::array<It, K> cur, end;
+  std::size_t n = 0;
+  for (const auto& run : runs) {
+    if (std::ranges::empty(run)) continue;
+    cur[n] = std::ranges::begin(run);
+    end[n++] = std::ranges::end(run);
+  }
+  return fixed_merge_n<K>(cur, end, n, out, comp);
+}
+
+}  // namespace detail
+
+/// Merge of exactly K runs, K fixed at compile time: `nway::merge<4>(runs, out)`.
+/// Uses an unrolled selection network (K - 1 branch-free comparisons per
+/// element) instead of a heap or tree. Stable across runs.
+template <std::size_t K, RunRange Runs, class OutputIt, class Compare = std::less<>>
+  requires(K >= 1)
+OutputIt merge(const Runs& runs, OutputIt out, Compare comp = Compare()) {
+  if (std::ranges::size(runs) != K) throw std::invalid_argument("nway::merge<K>: run count != K");
+  return detail::fixed_merge<K>(runs, out, comp);
+}
+
+/// Runtime-K entry to the fixed-K merges for 1 <= K <= kFixedMaxK.
+template <RunRange Runs, class OutputIt, class Compare = std::less<>>
+OutputIt fixed_merge(const Runs& runs, OutputIt out, Compare comp = Compare()) {
+  switch (std::ranges::size(runs)) {
+    case 0: return out;
+    case 1: return detail::fixed_merge<1>(runs, out, comp);
+    case 2: return detail::fixed_merge<2>(runs, out, comp);
+    case 3: return detail::fixed_merge<3>(runs, out, comp);
+    case 4: return detail::fixed_merge<4>(runs, out, comp);
+    case 5: return detail::fixed_merge<5>(runs, out, comp);
+    case 6: return detail::fixed_merge<6>(runs, out, comp);
+    case 7: return detail::fixed_merge<7>(runs, out, comp);
+    case 8: return detail::fixed_merge<8>(runs, out, comp);
+    default: throw std::invalid_argument("nway::fixed_merge: more than kFixedMaxK runs");
+  }
+}
+
+}  // namespace nway
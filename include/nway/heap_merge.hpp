@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "run.hpp"
+
+namespace nway {
+
+/// Reference K-way merge over a binary min-heap of run heads. Each output
+/// element costs a sift-down of about 2*log2(K) comparisons; kept as the
+/// baseline the other engines are measured against. Stable across runs.
+template <RunRange Runs, class OutputIt, class Compare = std::less<>>
+OutputIt heap_merge(const Runs& runs, OutputIt out, Compare comp = Compare()) {
+  using T = run_value_t<Runs>;
+  struct Entry {
+    T key;
+    std::size_t run;
+  };
+  // Strict (key, run) order with one call to comp.
+  auto before = [&](const Entry& a, const Entry& b) {
+    return a.run < b.run ? !comp(b.key, a.key) : comp(a.key, b.key);
+  };
+
+  const std::size_t k = std::ranges::size(runs);
+  std::vector<Entry> heap;
+  heap.reserve(k);
+  std::vector<std::size_t> pos(k, 1);
+  for (std::size_t i = 0; i < k; ++i)
+    if (!std::ranges::empty(runs[i])) heap.push_back({runs[i][0], i});
+
+  auto sift_down = [&](std::size_t i) {
+    const std::size_t n = heap.size();
+    Entry e = std::move(heap[i]);
+    for (std::size_t c; (c = 2 * i + 1) < n; i = c) {
+      if (c + 1 < n && before(heap[c + 1], heap[c])) ++c;
+      if (!before(heap[c], e)) break;
+      heap[i] = std::move(heap[c]);
+    }
+    heap[i] = std::move(e);
+  };
+  for (std::size_t i = heap.size() / 2; i-- > 0;) sift_down(i);
+
+  while (!heap.empty()) {
+    Entry& top = heap.front();
+    *out++ = top.key;
+    const auto& run = runs[top.run];
+    if (pos[top.run] < std::ranges::size(run)) {
+      top.key = run[pos[top.run]++];
+    } else {
+      heap.front() = std::move(heap.back());
+      heap.pop_back();
+      if (heap.empty()) break;
+    }
+    sift_down(0);
+  }
+  return out;
+}
+
+}  // namespace nway
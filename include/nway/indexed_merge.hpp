@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+#include "loser_tree.hpp"
+#include "run.hpp"
+
+namespace nway {
+
+/// Where a merged element came from: runs[run][offset].
+struct RunPosition {
+  std::uint64_t offset;
+  std::uint32_t run;
+
+  bool operator==(const RunPosition&) const = default;
+};
+
+namespace detail {
+
+// Drives a loser tree over the extracted keys only; `emit(run, offset)` is
+// called once per element in merged order.
+template <RunRange Runs, class KeyFn, class Compare, class Emit>
+void merge_keys(const Runs& runs, KeyFn& key, Compare& comp, Emit emit) {
+  using Key = std::remove_cvref_t<std::invoke_result_t<KeyFn&, const run_value_t<Runs>&>>;
+  const std::size_t k = std::ranges::size(runs);
+  LoserTree<Key, Compare> tree(comp);
+  tree.reset(k);
+  std::vector<std::size_t> pos(k, 0);
+  for (std::size_t i = 0; i < k; ++i)
+    if (!std::ranges::empty(runs[i])) tree.set(i, std::invoke(key, runs[i][0]));
+  tree.build();
+  while (!tree.empty()) {
+    const std::size_t s = tree.top_leaf();
+    const auto& run = runs[s];
+    emit(s, pos[s]);
+    if (++pos[s] < std::ranges::size(run))
+      tree.replace_top(std::invoke(key, run[pos[s]]));
+    else
+      tree.retire_top();
+  }
+}
+
+}  // namespace detail
+
+/// Merges runs of wide records while only the keys move through the tree:
+/// each record is copied exactly once, from its run straight into `out`.
+/// `key` projects a record to its (small) sort key. Stable across runs.
+template <RunRange Runs, class OutputIt, class KeyFn, class Compare = std::less<>>
+OutputIt indexed_merge(const Runs& runs, OutputIt out, KeyFn key, Compare comp = Compare()) {
+  detail::merge_keys(runs, key, comp,
+                     [&](std::size_t run, std::size_t offset) { *out++ = runs[run][offset]; });
+  return out;
+}
+
+/// Computes the merge order without touching payloads: element i of the
+/// result names the run and offset of the i-th merged record.
+template <RunRange Runs, class KeyFn, class Compare = std::less<>>
+std::vector<RunPosition> merge_permutation(const Runs& runs, KeyFn key, Compare comp = Compare()) {
+  std::size_t total = 0;
+  for (const auto& run : runs) total += std::ranges::size(run);
+  std::vector<RunPosition> perm;
+  perm.reserve(total);
+  detail::merge_keys(runs, key, comp, [&](std::size_t run, std::size_t offset) {
+    perm.push_back({offset, static_cast<std::uint32_t>(run)});
+  });
+  return perm;
+}
+
+/// Copies records into `out` in the order given by merge_permutation().
+template <RunRange Runs, class OutputIt>
+OutputIt gather(const Runs& runs, const std::vector<RunPosition>& perm, OutputIt out) {
+  for (const auto& p : perm) *out++ = runs[p.run][p.offset];
+  return out;
+}
+
+}  // namespace nway
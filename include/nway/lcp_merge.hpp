@@ -0,0 +1,217 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ranges>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "run.hpp"
+
+namespace nway {
+
+namespace detail {
+
+// Length of the common prefix of a and b, scanning from `from` (which must
+// not exceed either length) eight bytes at a time.
+inline std::size_t common_prefix(std::string_view a, std::string_view b, std::size_t from) {
+  const std::size_t n = std::min(a.size(), b.size());
+  std::size_t i = from;
+  if constexpr (std::endian::native == std::endian::little) {
+    for (; i + 8 <= n; i += 8) {
+      std::uint64_t x, y;
+      std::memcpy(&x, a.data() + i, 8);
+      std::memcpy(&y, b.data() + i, 8);
+      if (x != y) return i + static_cast<std::size_t>(std::countr_zero(x ^ y)) / 8;
+    }
+  }
+  while (i < n && a[i] == b[i]) ++i;
+  return i;
+}
+
+}  // namespace detail
+
+/// Loser tree over K string leaves that keeps, next to every leaf, the
+/// length of the longest common prefix (LCP) between the leaf's string and
+/// the string that beat it. All leaves on the winner's path lost to the
+/// string just output, so after each pop their LCPs share one reference.
+/// When two of them meet, differing LCPs decide the match without looking
+/// at a character. Equal LCPs resume the character comparison at that
+/// offset, so a shared prefix is never re-read (LCP-merge). The LCP of each
+/// output string with its predecessor falls out for free.
+///
+/// Strings compare as by std::string_view::compare (unsigned bytes); ties
+/// go to the lower leaf, so merges driven by the tree are stable.
+class LcpLoserTree {
+ public:
+  using Index = std::uint32_t;
+
+  /// Resizes to `k` leaves, all retired. Keeps capacity for reuse.
+  void reset(std::size_t k) {
+    k_ = static_cast<Index>(k);
+    keys_.assign(k, {});
+    lcp_.assign(k, 0);
+    live_.assign(k, 0);
+    nodes_.assign(k == 0 ? 1 : k, 0);
+  }
+
+  /// Seeds leaf `leaf` with its first string. Call between reset() and build().
+  void set(std::size_t leaf, std::string_view key) {
+    keys_[leaf] = key;
+    lcp_[leaf] = 0;
+    live_[leaf] = 1;
+  }
+
+  /// Plays the initial tournament bottom-up: K - 1 comparisons.
+  void build() {
+    if (k_ == 0) return;
+    win_.resize(2 * std::size_t(k_));
+    for (Index i = 0; i < k_; ++i) win_[k_ + i] = i;
+    for (Index n = k_ - 1; n > 0; --n) {
+      // Winners keep their LCP of 0, relative to the empty string.
+      const Index a = win_[2 * n], b = win_[2 * n + 1];
+      if (beats(a, b)) {
+        win_[n] = a;
+        nodes_[n] = b;
+      } else {
+        win_[n] = b;
+        nodes_[n] = a;
+      }
+    }
+    nodes_[0] = k_ == 1 ? 0 : win_[1];
+  }
+
+  std::size_t size() const { return k_; }
+  bool empty() const { return k_ == 0 || !live_[nodes_[0]]; }
+
+  std::size_t top_leaf() const { return nodes_[0]; }
+  std::string_view top() const { return keys_[nodes_[0]]; }
+
+  /// LCP of top() with the string output before it (0 for the first).
+  std::size_t top_lcp() const { return lcp_[nodes_[0]]; }
+
+  /// The winning leaf produced its next string, whose LCP with top() is
+  /// `lcp` (e.g. from the run's LCP array).
+  void replace_top(std::string_view key, std::size_t lcp) {
+    const Index w = nodes_[0];
+    keys_[w] = key;
+    lcp_[w] = lcp;
+    replay(w);
+  }
+
+  /// As above, computing the LCP with top() directly.
+  void replace_top(std::string_view key) {
+    replace_top(key, detail::common_prefix(keys_[nodes_[0]], key, 0));
+  }
+
+  /// The winning leaf is exhausted.
+  void retire_top() {
+    const Index w = nodes_[0];
+    live_[w] = 0;
+    replay(w);
+  }
+
+ private:
+  // Plays a against b, whose LCPs are relative to the same string, which
+  // sorts no later than either. Leaves the loser's LCP relative to the
+  // winner; the winner's stays as it was. Retired leaves lose.
+  bool beats(Index a, Index b) {
+    if (!(live_[a] & live_[b])) return live_[a] || (!live_[b] && a < b);
+    const std::size_t ha = lcp_[a], hb = lcp_[b];
+    // The one that agrees with the reference for longer is smaller.
+    if (ha != hb) return ha > hb;
+    const std::string_view sa = keys_[a], sb = keys_[b];
+    const std::size_t h = detail::common_prefix(sa, sb, ha);
+    bool a_wins;
+    if (h == sa.size() || h == sb.size())
+      a_wins = sa.size() != sb.size() ? sa.size() < sb.size() : a < b;
+    else
+      a_wins = static_cast<unsigned char>(sa[h]) < static_cast<unsigned char>(sb[h]);
+    lcp_[a_wins ? b : a] = h;
+    return a_wins;
+  }
+
+  void replay(Index w) {
+    for (Index n = (w + k_) >> 1; n > 0; n >>= 1) {
+      const Index loser = nodes_[n];
+      if (beats(loser, w)) {
+        nodes_[n] = w;
+        w = loser;
+      }
+    }
+    nodes_[0] = w;
+  }
+
+  Index k_ = 0;
+  std::vector<Index> nodes_;
+  std::vector<std::string_view> keys_;
+  std::vector<std::size_t> lcp_;  // per leaf: LCP with the string that beat it
+  std::vector<std::uint8_t> live_;
+  std::vector<Index> win_;
+};
+
+namespace detail {
+
+// Drives an LcpLoserTree over `runs`; advance(tree, s, j) replaces the top
+// with runs[s][j].
+template <class Runs, class OutputIt, class Advance>
+OutputIt lcp_merge_with(const Runs& runs, OutputIt out, std::size_t* lcp_out, Advance advance) {
+  const std::size_t k = std::ranges::size(runs);
+  LcpLoserTree tree;
+  tree.reset(k);
+  std::vector<std::size_t> pos(k, 0);
+  for (std::size_t i = 0; i < k; ++i) {
+    if (!std::ranges::empty(runs[i])) {
+      tree.set(i, runs[i][0]);
+      pos[i] = 1;
+    }
+  }
+  tree.build();
+  for (bool first = true; !tree.empty(); first = false) {
+    const std::size_t s = tree.top_leaf();
+    const auto& run = runs[s];
+    *out++ = run[pos[s] - 1];
+    if (lcp_out) *lcp_out++ = first ? 0 : tree.top_lcp();
+    if (pos[s] < std::ranges::size(run))
+      advance(tree, s, pos[s]++);
+    else
+      tree.retire_top();
+  }
+  return out;
+}
+
+}  // namespace detail
+
+/// Merges K sorted runs of strings (anything convertible to
+/// std::string_view) into `out` with an LcpLoserTree. Stable across runs.
+/// When `lcp_out` is given, lcp_out[i] receives the LCP of the i-th output
+/// string with the one before it (0 for the first): the LCP array that the
+/// next merge of this output can take as input.
+template <RunRange Runs, class OutputIt>
+  requires std::is_convertible_v<const run_value_t<Runs>&, std::string_view>
+OutputIt lcp_merge(const Runs& runs, OutputIt out, std::size_t* lcp_out = nullptr) {
+  return detail::lcp_merge_with(runs, out, lcp_out,
+                                [&](LcpLoserTree& tree, std::size_t s, std::size_t j) {
+                                  tree.replace_top(runs[s][j]);
+                                });
+}
+
+/// As above, with each run's LCP array given: lcps[i][j] is the LCP of
+/// runs[i][j - 1] and runs[i][j] (lcps[i][0] is ignored). Then no input
+/// string is compared with its predecessor at all.
+template <RunRange Runs, RunRange Lcps, class OutputIt>
+  requires std::is_convertible_v<const run_value_t<Runs>&, std::string_view> &&
+           std::is_convertible_v<const run_value_t<Lcps>&, std::size_t>
+OutputIt lcp_merge(const Runs& runs, const Lcps& lcps, OutputIt out,
+                   std::size_t* lcp_out = nullptr) {
+  return detail::lcp_merge_with(runs, out, lcp_out,
+                                [&](LcpLoserTree& tree, std::size_t s, std::size_t j) {
+                                  tree.replace_top(runs[s][j], lcps[s][j]);
+                                });
+}
+
+}  // namespace nway
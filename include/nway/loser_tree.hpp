@@ -0,0 +1,183 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "detail/aligned_allocator.hpp"
+#include "run.hpp"
+
+namespace nway {
+
+/// Tournament tree of losers over K leaves. Each leaf holds the current head of
+/// one input; after the caller replaces or retires the winner only its
+/// leaf-to-root path is replayed, i.e. ceil(log2 K) comparisons per element.
+/// Ties go to the lower leaf index, so merges driven by the tree are stable.
+///
+/// Node k (1 <= k < K) stores the leaf that lost the match played there and
+/// node 0 the overall winner; leaf i sits implicitly at position K + i.
+template <class T, class Compare = std::less<>>
+class LoserTree {
+ public:
+  using Index = std::uint32_t;
+
+  explicit LoserTree(Compare comp = Compare()) : comp_(std::move(comp)) {}
+
+  /// Resizes to `k` leaves, all retired. Keeps capacity for reuse.
+  void reset(std::size_t k) {
+    k_ = static_cast<Index>(k);
+    keys_.resize(k);
+    live_.assign(k, 0);
+    deferred_.clear();
+    nodes_.assign(k == 0 ? 1 : k, 0);
+  }
+
+  /// Seeds leaf `leaf` with its first key. Call between reset() and build().
+  void set(std::size_t leaf, T key) {
+    keys_[leaf] = std::move(key);
+    live_[leaf] = 1;
+  }
+
+  /// Plays the initial tournament bottom-up: K - 1 comparisons.
+  void build() {
+    if (k_ == 0) return;
+    win_.resize(2 * std::size_t(k_));
+    for (Index i = 0; i < k_; ++i) win_[k_ + i] = i;
+    for (Index n = k_ - 1; n > 0; --n) {
+      Index a = win_[2 * n], b = win_[2 * n + 1];
+      if (beats(a, b)) {
+        win_[n] = a;
+        nodes_[n] = b;
+      } else {
+        win_[n] = b;
+        nodes_[n] = a;
+      }
+    }
+    nodes_[0] = k_ == 1 ? 0 : win_[1];
+  }
+
+  std::size_t size() const { return k_; }
+  bool empty() const { return k_ == 0 || !live_[nodes_[0]]; }
+
+  std::size_t top_leaf() const { return nodes_[0]; }
+  const T& top() const { return keys_[nodes_[0]]; }
+
+  const T& key(std::size_t leaf) const { return keys_[leaf]; }
+
+  /// Leaf that would win if the current winner left: the best of the losers
+  /// on the winner's path, about ceil(log2 K) comparisons. Returns size()
+  /// when no other leaf is live.
+  std::size_t runner_up() const {
+    Index w = nodes_[0];
+    Index best = w;
+    for (Index n = (w + k_) >> 1; n > 0; n >>= 1)
+      if (best == w || beats(nodes_[n], best)) best = nodes_[n];
+    return best != w && live_[best] ? best : k_;
+  }
+
+  /// The winning leaf produced its next key.
+  void replace_top(T key) {
+    Index w = nodes_[0];
+    keys_[w] = std::move(key);
+    replay(w);
+  }
+
+  /// The winning leaf is exhausted.
+  void retire_top() {
+    Index w = nodes_[0];
+    live_[w] = 0;
+    replay(w);
+  }
+
+  /// Replacement selection: the winning leaf's next key sorts before the key
+  /// just output, so it belongs to the next run. The leaf drops out like a
+  /// retired one until revive().
+  void defer_top(T key) {
+    Index w = nodes_[0];
+    if (deferred_.size() != k_) deferred_.assign(k_, 0);
+    keys_[w] = std::move(key);
+    live_[w] = 0;
+    deferred_[w] = 1;
+    replay(w);
+  }
+
+  /// Makes every deferred leaf live again and replays the whole tournament
+  /// (K - 1 comparisons). Unlike build() it needs no scratch, so it can also
+  /// stand in for build() where memory is counted per leaf.
+  void revive() {
+    for (Index i = 0; i < deferred_.size(); ++i) {
+      live_[i] |= deferred_[i];
+      deferred_[i] = 0;
+    }
+    if (k_ > 0) nodes_[0] = play(1);
+  }
+
+ private:
+  // Strict (key, leaf) order with one call to comp_; retired leaves lose.
+  bool beats(Index a, Index b) const {
+    if (!(live_[a] & live_[b])) return live_[a] || (!live_[b] && a < b);
+    return a < b ? !comp_(keys_[b], keys_[a]) : comp_(keys_[a], keys_[b]);
+  }
+
+  // Winner of the subtree under position `n`, storing the losers on the way.
+  Index play(Index n) {
+    if (n >= k_) return k_ == 1 ? 0 : n - k_;
+    const Index a = play(2 * n), b = play(2 * n + 1);
+    if (beats(a, b)) {
+      nodes_[n] = b;
+      return a;
+    }
+    nodes_[n] = a;
+    return b;
+  }
+
+  void replay(Index w) {
+    for (Index n = (w + k_) >> 1; n > 0; n >>= 1) {
+      Index loser = nodes_[n];
+      if (beats(loser, w)) {
+        nodes_[n] = w;
+        w = loser;
+      }
+    }
+    nodes_[0] = w;
+  }
+
+  Compare comp_;
+  Index k_ = 0;
+  std::vector<Index, detail::AlignedAllocator<Index>> nodes_;
+  std::vector<T> keys_;
+  std::vector<std::uint8_t> live_;
+  std::vector<std::uint8_t> deferred_;  // only sized once defer_top() is used
+  std::vector<Index> win_;
+};
+
+/// Merges the sorted runs into `out` with a loser tree. Stable across runs.
+template <RunRange Runs, class OutputIt, class Compare = std::less<>>
+OutputIt loser_tree_merge(const Runs& runs, OutputIt out, Compare comp = Compare()) {
+  using T = run_value_t<Runs>;
+  const std::size_t k = std::ranges::size(runs);
+  LoserTree<T, Compare> tree(std::move(comp));
+  tree.reset(k);
+  std::vector<std::size_t> pos(k, 0);
+  for (std::size_t i = 0; i < k; ++i) {
+    if (!std::ranges::empty(runs[i])) {
+      tree.set(i, runs[i][0]);
+      pos[i] = 1;
+    }
+  }
+  tree.build();
+  while (!tree.empty()) {
+    std::size_t s = tree.top_leaf();
+    *out++ = tree.top();
+    const auto& run = runs[s];
+    if (pos[s] < std::ranges::size(run))
+      tree.replace_top(run[pos[s]++]);
+    else
+      tree.retire_top();
+  }
+  return out;
+}
+
+}  // namespace nway
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "fixed_merge.hpp"
+#include "loser_tree.hpp"
+#include "run.hpp"
+#include "simd_merge.hpp"
+
+namespace nway {
+
+namespace detail {
+
+// Runs and output that the bitonic SIMD kernels can take over: supported
+// integer key type, natural ascending order, contiguous memory on both sides.
+// Float keys stay on the stable engines, since the kernels may swap -0.0 and
+// +0.0.
+template <class Runs, class OutputIt, class Compare>
+inline constexpr bool simd_mergeable_v = false;
+
+template <class Runs, class OutputIt, class Compare>
+  requires std::contiguous_iterator<OutputIt>
+inline constexpr bool simd_mergeable_v<Runs, OutputIt, Compare> =
+    is_simd_key_v<run_value_t<Runs>> && std::is_integral_v<run_value_t<Runs>> &&
+    (std::is_same_v<Compare, std::less<>> || std::is_same_v<Compare, std::less<run_value_t<Runs>>>) &&
+    std::ranges::contiguous_range<std::ranges::range_reference_t<const Runs&>> &&
+    std::is_same_v<std::iter_value_t<OutputIt>, run_value_t<Runs>>;
+
+}  // namespace detail
+
+/// Merges K sorted runs into `out`. Stable: equal elements keep run order.
+///
+/// Small K over uint32/uint64 keys in natural order goes to the SIMD
+/// bitonic kernels (simd_merge.hpp), other K <= kFixedMaxK to the unrolled
+/// fixed-K merges (fixed_merge.hpp); everything else uses the loser tree.
+template <RunRange Runs, class OutputIt, class Compare = std::less<>>
+OutputIt merge(const Runs& runs, OutputIt out, Compare comp = Compare()) {
+  if constexpr (detail::simd_mergeable_v<Runs, OutputIt, Compare>) {
+    using T = run_value_t<Runs>;
+    const std::size_t k = std::ranges::size(runs);
+    if (k <= kSimdMaxK) {
+      std::vector<std::span<const T>> spans;
+      spans.reserve(k);
+      for (const auto& run : runs) spans.emplace_back(std::ranges::data(run), std::ranges::size(run));
+      T* first = std::to_address(out);
+      return out + (simd_merge<T>(spans, first) - first);
+    }
+  }
+  if (std::ranges::size(runs) <= kFixedMaxK) return fixed_merge(runs, out, std::move(comp));
+  return loser_tree_merge(runs, out, std::move(comp));
+}
+
+/// Merges K sorted runs into a freshly allocated vector.
+template <RunRange Runs, class Compare = std::less<>>
+std::vector<run_value_t<Runs>> merge_to_vector(const Runs& runs, Compare comp = Compare()) {
+  std::size_t total = 0;
+  for (const auto& run : runs) total += std::ranges::size(run);
+  std::vector<run_value_t<Runs>> result;
+  using Out = typename std::vector<run_value_t<Runs>>::iterator;
+  if constexpr (detail::simd_mergeable_v<Runs, Out, Compare>) {
+    // The SIMD kernels write through a raw pointer; integer keys are cheap to
+    // value-initialise first.
+    result.resize(total);
+    merge(runs, result.begin(), std::move(comp));
+  } else {
+    result.reserve(total);
+    merge(runs, std::back_inserter(result), std::move(comp));
+  }
+  return result;
+}
+
+}  // namespace nway
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <ranges>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+#include "arena.hpp"
+#include "fixed_merge.hpp"
+#include "loser_tree.hpp"
+#include "merge.hpp"
+#include "run.hpp"
+#include "simd_merge.hpp"
+
+namespace nway {
+
+/// Reusable state for many small merges, e.g. K ~ 16 lists of ~100 elements
+/// per query. The loser tree keeps its node and key storage between calls
+/// and all per-call scratch (cursor positions, and the output for the span
+/// overload) comes from an Arena that is reset at the start of each call.
+/// Once the context has seen the largest K and total, merges allocate
+/// nothing.
+///
+/// Dispatches like nway::merge: small K to the SIMD kernels (with scratch
+/// from the arena) or the fixed-K merges, larger K to the loser tree. Stable
+/// across runs. Not thread-safe: use one per thread.
+template <class T, class Compare = std::less<>>
+class MergeContext {
+ public:
+  explicit MergeContext(Compare comp = Compare()) : comp_(comp), tree_(std::move(comp)) {}
+
+  /// Merges `runs` into `out`.
+  template <RunRange Runs, class OutputIt>
+    requires std::is_same_v<run_value_t<Runs>, T>
+  OutputIt merge(const Runs& runs, OutputIt out) {
+    arena_.reset();
+    return merge_into(runs, out);
+  }
+
+  /// Merges `runs` into storage owned by the context's arena. The result
+  /// stays valid until the next call.
+  template <RunRange Runs>
+    requires std::is_same_v<run_value_t<Runs>, T> && std::is_trivially_destructible_v<T>
+  std::span<const T> merge(const Runs& runs) {
+    std::size_t total = 0;
+    for (const auto& run : runs) total += std::ranges::size(run);
+    arena_.reset();
+    std::span<T> result = arena_.allocate<T>(total);
+    merge_into(runs, result.data());
+    return result;
+  }
+
+  Arena& arena() { return arena_; }
+
+ private:
+  template <RunRange Runs, class OutputIt>
+  OutputIt merge_into(const Runs& runs, OutputIt out) {
+    const std::size_t k = std::ranges::size(runs);
+    if constexpr (detail::simd_mergeable_v<Runs, OutputIt, Compare>) {
+      if (k <= kSimdMaxK) {
+        std::array<std::span<const T>, kSimdMaxK> spans;
+        std::size_t total = 0;
+        for (std::size_t i = 0; i < k; ++i) {
+          spans[i] = {std::ranges::data(runs[i]), std::ranges::size(runs[i])};
+          total += spans[i].size();
+        }
+        T* first = std::to_address(out);
+        T* last = simd_merge<T>(std::span(spans.data(), k), first, arena_.allocate<T>(total).data());
+        return out + (last - first);
+      }
+    }
+    if (k <= kFixedMaxK) return fixed_merge(runs, out, comp_);
+
+    std::span<std::size_t> pos = arena_.allocate<std::size_t>(k);
+    tree_.reset(k);
+    for (std::size_t i = 0; i < k; ++i) {
+      pos[i] = 0;
+      if (!std::ranges::empty(runs[i])) {
+        tree_.set(i, runs[i][0]);
+        pos[i] = 1;
+      }
+    }
+    tree_.build();
+    while (!tree_.empty()) {
+      const std::size_t s = tree_.top_leaf();
+      *out++ = tree_.top();
+      const auto& run = runs[s];
+      if (pos[s] < std::ranges::size(run))
+        tree_.replace_top(run[pos[s]++]);
+      else
+        tree_.retire_top();
+    }
+    return out;
+  }
+
+  Compare comp_;
+  LoserTree<T, Compare> tree_;
+  Arena arena_;
+};
+
+}  // namespace nway
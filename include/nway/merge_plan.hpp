@@ -0,0 +1,119 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace nway {
+
+/// One merge of a MergePlan. Ids below the number of initial runs name those
+/// runs; id `runs + j` names the output of step j.
+struct MergeStep {
+  std::vector<std::size_t> inputs;
+  std::uint64_t bytes = 0;  ///< sum of the input sizes: what the step reads and writes
+  std::size_t pass = 0;     ///< 1 + the latest pass among the inputs (initial runs: 0)
+};
+
+/// Order of the merges that reduce a set of runs to one.
+struct MergePlan {
+  std::vector<MergeStep> steps;           ///< in execution order; the last produces the result
+  std::vector<std::uint64_t> pass_bytes;  ///< predicted bytes read per pass; [0] is pass 1
+
+  std::size_t passes() const { return pass_bytes.size(); }
+  std::uint64_t total_bytes() const {
+    std::uint64_t sum = 0;
+    for (std::uint64_t b : pass_bytes) sum += b;
+    return sum;
+  }
+};
+
+namespace detail {
+
+inline void add_step(MergePlan& plan, std::vector<std::size_t> inputs,
+                     std::vector<std::uint64_t>& bytes, std::vector<std::size_t>& pass) {
+  MergeStep step;
+  for (std::size_t id : inputs) {
+    step.bytes += bytes[id];
+    step.pass = std::max(step.pass, pass[id] + 1);
+  }
+  step.inputs = std::move(inputs);
+  if (plan.pass_bytes.size() < step.pass) plan.pass_bytes.resize(step.pass, 0);
+  plan.pass_bytes[step.pass - 1] += step.bytes;
+  bytes.push_back(step.bytes);
+  pass.push_back(step.pass);
+  plan.steps.push_back(std::move(step));
+}
+
+inline void check_fan_in(std::size_t fan_in) {
+  if (fan_in < 2) throw std::invalid_argument("merge fan-in must be at least 2");
+}
+
+}  // namespace detail
+
+/// Merges in arrival order, level by level: consecutive groups of `fan_in`
+/// runs while more than `fan_in` remain (a lone leftover run moves up
+/// unmerged), then one final merge. Every record is read once per level, so
+/// a large run is reread as often as the smallest one.
+inline MergePlan plan_arrival_merges(std::span<const std::uint64_t> run_bytes,
+                                     std::size_t fan_in) {
+  detail::check_fan_in(fan_in);
+  MergePlan plan;
+  std::vector<std::uint64_t> bytes(run_bytes.begin(), run_bytes.end());
+  std::vector<std::size_t> pass(bytes.size(), 0);
+  std::vector<std::size_t> level(bytes.size());
+  for (std::size_t i = 0; i < level.size(); ++i) level[i] = i;
+  while (level.size() > 1) {
+    const std::size_t group = level.size() > fan_in ? fan_in : level.size();
+    std::vector<std::size_t> next;
+    for (std::size_t i = 0; i < level.size(); i += group) {
+      const std::size_t end = std::min(level.size(), i + group);
+      if (end - i == 1) {
+        next.push_back(level[i]);
+        continue;
+      }
+      next.push_back(bytes.size());
+      detail::add_step(plan, {level.begin() + i, level.begin() + end}, bytes, pass);
+    }
+    level = std::move(next);
+  }
+  return plan;
+}
+
+/// Minimum-I/O merge order for runs of unequal size: the K-ary Huffman tree
+/// over the run sizes. Each step merges the `fan_in` smallest runs still
+/// pending, so small runs are merged early and the largest ones are touched
+/// only by the last merges. The first step takes just enough runs,
+/// 2 + (n - 2) mod (fan_in - 1), that every later step is a full `fan_in`
+/// merge, which is what makes the total bytes moved minimal. Ties go to the
+/// earlier run.
+inline MergePlan plan_huffman_merges(std::span<const std::uint64_t> run_bytes,
+                                     std::size_t fan_in) {
+  detail::check_fan_in(fan_in);
+  MergePlan plan;
+  const std::size_t n = run_bytes.size();
+  if (n <= 1) return plan;
+  std::vector<std::uint64_t> bytes(run_bytes.begin(), run_bytes.end());
+  std::vector<std::size_t> pass(n, 0);
+  using Entry = std::pair<std::uint64_t, std::size_t>;  // (bytes, id)
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<>> pending;
+  for (std::size_t i = 0; i < n; ++i) pending.emplace(bytes[i], i);
+  for (std::size_t take = 2 + (n - 2) % (fan_in - 1); pending.size() > 1; take = fan_in) {
+    std::vector<std::size_t> inputs;
+    for (; take > 0 && !pending.empty(); --take) {
+      inputs.push_back(pending.top().second);
+      pending.pop();
+    }
+    const std::size_t id = bytes.size();
+    detail::add_step(plan, std::move(inputs), bytes, pass);
+    pending.emplace(bytes[id], id);
+  }
+  return plan;
+}
+
+}  // namespace nway
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "loser_tree.hpp"
+
+namespace nway {
+
+/// Lazy K-way merge over arbitrary input ranges (containers, generators,
+/// RunReader cursors, ...). Elements are produced on demand as the view is
+/// iterated, so stopping early costs nothing; working memory is the loser tree
+/// and one iterator per input, O(K). Single pass: begin() may be called once.
+/// Stable across inputs.
+template <std::ranges::input_range Input, class Compare = std::less<>>
+  requires std::ranges::view<Input>
+class merge_view : public std::ranges::view_interface<merge_view<Input, Compare>> {
+ public:
+  using value_type = std::ranges::range_value_t<Input>;
+
+  class iterator {
+   public:
+    using value_type = merge_view::value_type;
+    using difference_type = std::ptrdiff_t;
+    using iterator_concept = std::input_iterator_tag;
+
+    iterator() = default;
+
+    const value_type& operator*() const { return parent_->tree_.top(); }
+    iterator& operator++() {
+      parent_->advance();
+      return *this;
+    }
+    void operator++(int) { ++*this; }
+
+    friend bool operator==(const iterator& it, std::default_sentinel_t) { return it.at_end(); }
+
+   private:
+    friend merge_view;
+    explicit iterator(merge_view* parent) : parent_(parent) {}
+    bool at_end() const { return parent_->tree_.empty(); }
+    merge_view* parent_ = nullptr;
+  };
+
+  merge_view() = default;
+  explicit merge_view(std::vector<Input> inputs, Compare comp = Compare())
+      : inputs_(std::move(inputs)), tree_(std::move(comp)) {}
+
+  iterator begin() {
+    prime();
+    return iterator(this);
+  }
+  std::default_sentinel_t end() const { return {}; }
+
+ private:
+  void prime() {
+    const std::size_t k = inputs_.size();
+    its_.clear();
+    ends_.clear();
+    its_.reserve(k);
+    ends_.reserve(k);
+    tree_.reset(k);
+    for (std::size_t i = 0; i < k; ++i) {
+      its_.push_back(std::ranges::begin(inputs_[i]));
+      ends_.push_back(std::ranges::end(inputs_[i]));
+      if (its_[i] != ends_[i]) tree_.set(i, *its_[i]);
+    }
+    tree_.build();
+  }
+
+  void advance() {
+    const std::size_t s = tree_.top_leaf();
+    if (++its_[s] != ends_[s])
+      tree_.replace_top(*its_[s]);
+    else
+      tree_.retire_top();
+  }
+
+  std::vector<Input> inputs_;
+  std::vector<std::ranges::iterator_t<Input>> its_;
+  std::vector<std::ranges::sentinel_t<Input>> ends_;
+  LoserTree<value_type, Compare> tree_;
+};
+
+namespace views {
+
+/// `nway::views::merge(inputs[, comp])` or `inputs | nway::views::merge`:
+/// a merge_view over every range in `inputs`. Lvalue inputs are referenced
+/// and must outlive the view; rvalue inputs are moved into it.
+struct MergeFn {
+  template <std::ranges::input_range Inputs, class Compare = std::less<>>
+    requires std::ranges::input_range<std::ranges::range_reference_t<Inputs>>
+  auto operator()(Inputs&& inputs, Compare comp = Compare()) const {
+    using Ref = std::conditional_t<std::is_lvalue_reference_v<Inputs>,
+                                   std::ranges::range_reference_t<Inputs>,
+                                   std::ranges::range_rvalue_reference_t<Inputs>>;
+    using Input = std::views::all_t<Ref>;
+    std::vector<Input> all;
+    for (auto&& input : inputs) all.push_back(std::views::all(static_cast<Ref>(input)));
+    return merge_view<Input, Compare>(std::move(all), std::move(comp));
+  }
+
+  template <std::ranges::input_range Inputs>
+  friend auto operator|(Inputs&& inputs, const MergeFn& self) {
+    return self(std::forward<Inputs>(inputs));
+  }
+};
+
+inline constexpr MergeFn merge;
+
+}  // namespace views
+
+}  // namespace nway
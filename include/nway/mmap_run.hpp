@@ -0,0 +1,151 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "detail/file.hpp"
+
+namespace nway {
+
+/// Sequential zero-copy reader over a memory-mapped file of raw `T` records;
+/// a drop-in alternative to RunReader.
+///
+/// The mapping is advised MADV_SEQUENTIAL. Whenever the cursor crosses a
+/// `window_bytes` boundary the window after the one it enters is advised
+/// MADV_WILLNEED, so roughly two windows per run stay resident. Windows
+/// already consumed are unmapped (MADV_DONTNEED) and then dropped from the
+/// page cache (POSIX_FADV_DONTNEED on the kept descriptor) instead of
+/// evicting other tenants.
+template <class T>
+class MappedRunReader {
+  static_assert(std::is_trivially_copyable_v<T>, "run records must be trivially copyable");
+
+ public:
+  class iterator {
+   public:
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using iterator_concept = std::input_iterator_tag;
+
+    iterator() = default;
+    explicit iterator(MappedRunReader* reader) : reader_(reader) {}
+
+    const T& operator*() const { return reader_->front(); }
+    iterator& operator++() {
+      reader_->pop();
+      return *this;
+    }
+    void operator++(int) { reader_->pop(); }
+    friend bool operator==(const iterator& it, std::default_sentinel_t) {
+      return it.reader_->empty();
+    }
+
+   private:
+    MappedRunReader* reader_ = nullptr;
+  };
+
+  MappedRunReader(const std::filesystem::path& path, std::size_t window_bytes)
+      : file_(detail::File::open_read(path)) {
+    bytes_ = file_.size();
+    if (bytes_ % sizeof(T) != 0) throw std::runtime_error("truncated record in " + path.string());
+    len_ = bytes_ / sizeof(T);
+    const std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    window_ = std::max(page, window_bytes / page * page);
+    if (bytes_ == 0) return;
+
+    void* p = ::mmap(nullptr, bytes_, PROT_READ, MAP_PRIVATE, file_.fd(), 0);
+    if (p == MAP_FAILED) detail::throw_errno("mmap " + path.string());
+    base_ = static_cast<const unsigned char*>(p);
+    data_ = reinterpret_cast<const T*>(base_);
+    ::madvise(const_cast<unsigned char*>(base_), bytes_, MADV_SEQUENTIAL);
+    willneed(0);
+    willneed(window_);
+    next_advice_ = first_record_past(window_);
+  }
+  MappedRunReader(MappedRunReader&& o) noexcept { swap(o); }
+  MappedRunReader& operator=(MappedRunReader&& o) noexcept {
+    MappedRunReader tmp(std::move(o));
+    swap(tmp);
+    return *this;
+  }
+  ~MappedRunReader() {
+    if (base_) ::munmap(const_cast<unsigned char*>(base_), bytes_);
+  }
+
+  bool empty() const { return pos_ == len_; }
+  const T& front() const { return data_[pos_]; }
+  void pop() {
+    if (++pos_ == next_advice_) advance_window();
+  }
+
+  iterator begin() { return iterator(this); }
+  std::default_sentinel_t end() const { return {}; }
+
+  /// Bytes of the file advised in (MADV_WILLNEED) so far; the page cache may
+  /// have held some of them already.
+  std::uint64_t bytes_read() const { return fetched_; }
+
+ private:
+  void swap(MappedRunReader& o) noexcept {
+    std::swap(file_, o.file_);
+    std::swap(base_, o.base_);
+    std::swap(data_, o.data_);
+    std::swap(bytes_, o.bytes_);
+    std::swap(window_, o.window_);
+    std::swap(len_, o.len_);
+    std::swap(pos_, o.pos_);
+    std::swap(next_advice_, o.next_advice_);
+    std::swap(released_, o.released_);
+    std::swap(fetched_, o.fetched_);
+  }
+
+  void willneed(std::size_t offset) {
+    if (offset >= bytes_) return;
+    const std::size_t n = std::min(window_, bytes_ - offset);
+    ::madvise(const_cast<unsigned char*>(base_) + offset, n, MADV_WILLNEED);
+    fetched_ = std::max<std::uint64_t>(fetched_, offset + n);
+  }
+
+  // Index of the first record starting at or after byte `offset`.
+  std::size_t first_record_past(std::size_t offset) const {
+    return std::min(len_, (offset + sizeof(T) - 1) / sizeof(T));
+  }
+
+  void advance_window() {
+    // Whole windows before the cursor are done.
+    const std::size_t consumed = pos_ * sizeof(T) / window_ * window_;
+    if (consumed > released_) {
+      // Unmapping alone leaves the pages cached; once unmapped the kernel
+      // can drop them.
+      ::madvise(const_cast<unsigned char*>(base_) + released_, consumed - released_, MADV_DONTNEED);
+      ::posix_fadvise(file_.fd(), static_cast<off_t>(released_),
+                      static_cast<off_t>(consumed - released_), POSIX_FADV_DONTNEED);
+      released_ = consumed;
+    }
+    willneed(consumed + window_);
+    next_advice_ = first_record_past(consumed + window_);
+  }
+
+  detail::File file_;
+  const unsigned char* base_ = nullptr;
+  const T* data_ = nullptr;
+  std::size_t bytes_ = 0;
+  std::size_t window_ = 0;
+  std::size_t len_ = 0;
+  std::size_t pos_ = 0;
+  std::size_t next_advice_ = 0;
+  std::size_t released_ = 0;
+  std::uint64_t fetched_ = 0;
+};
+
+}  // namespace nway
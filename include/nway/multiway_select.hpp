@@ -0,0 +1,87 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <vector>
+
+#include "run.hpp"
+
+namespace nway {
+
+/// Multi-sequence selection: returns per-run positions s such that
+/// sum(s) == rank and runs[i][0, s[i]) are exactly the `rank` smallest
+/// elements under the stable merge order (key, then run index, then position).
+/// Merging every run's [s_a, s_b) slice therefore yields precisely the
+/// [rank_a, rank_b) slice of the sequential stable merge.
+///
+/// Each round pivots on the weighted median of the window midpoints, which
+/// discards at least a quarter of the remaining candidates: O(K log K log N)
+/// comparisons overall.
+template <RunRange Runs, class Compare = std::less<>>
+std::vector<std::size_t> multiway_select(const Runs& runs, std::size_t rank,
+                                         Compare comp = Compare()) {
+  const std::size_t k = std::ranges::size(runs);
+  std::vector<std::size_t> lo(k, 0), hi(k), pos(k);
+  std::size_t total = 0;
+  for (std::size_t i = 0; i < k; ++i) total += hi[i] = std::ranges::size(runs[i]);
+  if (rank >= total) return hi;
+
+  struct Candidate {
+    std::size_t run, at, weight;
+  };
+  std::vector<Candidate> cand;
+  cand.reserve(k);
+  // Element order: key, then run index, then position within the run.
+  auto before = [&](const Candidate& a, const Candidate& b) {
+    const auto& x = runs[a.run][a.at];
+    const auto& y = runs[b.run][b.at];
+    if (a.run == b.run) return a.at < b.at;
+    return a.run < b.run ? !comp(y, x) : comp(x, y);
+  };
+
+  for (;;) {
+    cand.clear();
+    std::size_t remaining = 0;
+    for (std::size_t i = 0; i < k; ++i) {
+      if (lo[i] == hi[i]) continue;
+      cand.push_back({i, lo[i] + (hi[i] - lo[i]) / 2, hi[i] - lo[i]});
+      remaining += hi[i] - lo[i];
+    }
+    if (cand.empty()) return lo;
+
+    std::sort(cand.begin(), cand.end(), before);
+    std::size_t acc = 0;
+    auto pivot = cand.front();
+    for (const auto& c : cand) {
+      pivot = c;
+      if ((acc += c.weight) * 2 >= remaining) break;
+    }
+
+    // Count everything that precedes the pivot; each window bounds its search.
+    const auto& key = runs[pivot.run][pivot.at];
+    std::size_t below = 0;
+    for (std::size_t i = 0; i < k; ++i) {
+      const auto first = std::ranges::begin(runs[i]);
+      if (i == pivot.run) {
+        pos[i] = pivot.at;
+      } else if (i < pivot.run) {
+        pos[i] = std::upper_bound(first + lo[i], first + hi[i], key, comp) - first;
+      } else {
+        pos[i] = std::lower_bound(first + lo[i], first + hi[i], key, comp) - first;
+      }
+      below += pos[i];
+    }
+
+    if (below == rank) return pos;
+    if (below < rank) {
+      lo = pos;
+      ++lo[pivot.run];
+    } else {
+      hi = pos;
+    }
+  }
+}
+
+}  // namespace nway
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "detail/ordered_key.hpp"
+
+namespace nway {
+
+/// Direction of one column of a composite sort key.
+enum class KeyOrder { asc, desc };
+
+/// A record's composite key, encoded so that memcmp order (shorter first on
+/// a common prefix) is the composite order. `prefix` holds the first 8
+/// bytes big-endian, zero padded, so most comparisons are one integer
+/// compare; `data` points at the whole encoding. `row` is the caller's
+/// handle on the record (see NormalizedRun).
+struct NormalizedKey {
+  std::uint64_t prefix;
+  const std::byte* data;
+  std::uint32_t size;
+  std::uint32_t row;
+};
+
+/// Orders NormalizedKeys by one memcmp of their encodings.
+struct NormalizedMemcmpLess {
+  bool operator()(const NormalizedKey& a, const NormalizedKey& b) const {
+    const int c = std::memcmp(a.data, b.data, std::min(a.size, b.size));
+    return c != 0 ? c < 0 : a.size < b.size;
+  }
+};
+
+/// Orders NormalizedKeys by their 64-bit prefixes, falling back to memcmp
+/// of the remaining bytes when the prefixes tie.
+struct NormalizedPrefixLess {
+  bool operator()(const NormalizedKey& a, const NormalizedKey& b) const {
+    if (a.prefix != b.prefix) return a.prefix < b.prefix;
+    const std::uint32_t n = std::min(a.size, b.size);
+    if (n > 8) {
+      const int c = std::memcmp(a.data + 8, b.data + 8, n - 8);
+      if (c != 0) return c < 0;
+    }
+    return a.size < b.size;
+  }
+};
+
+namespace detail {
+
+// Appends the low `bytes` bytes of `v` most significant first, inverted
+// for descending columns.
+inline void put_big_endian(std::vector<std::byte>& out, std::uint64_t v, std::size_t bytes,
+                           KeyOrder order) {
+  if (order == KeyOrder::desc) v = ~v;
+  const std::size_t at = out.size();
+  out.resize(at + bytes);
+  for (std::size_t i = 0; i < bytes; ++i)
+    out[at + i] = static_cast<std::byte>(v >> (8 * (bytes - 1 - i)));
+}
+
+inline std::uint64_t load_prefix(const std::byte* p, std::size_t n) {
+  std::uint64_t v = 0;
+  for (std::size_t i = 0; i < 8; ++i)
+    v = v << 8 | (i < n ? std::to_integer<std::uint64_t>(p[i]) : 0);
+  return v;
+}
+
+}  // namespace detail
+
+/// Appends the columns of one composite key to a byte string:
+///
+/// - integers: fixed width, big-endian, sign bit flipped;
+/// - floating point: IEEE bits with the sign bit flipped for positives and
+///   every bit flipped for negatives; -0.0 is encoded as 0.0 and every NaN
+///   as one NaN that sorts after +infinity;
+/// - strings: each 0x00 byte escaped as 0x00 0xFF, then a 0x00 0x00
+///   terminator, so a string sorts before its extensions and the next column
+///   never bleeds into the comparison.
+///
+/// Descending columns store the bitwise complement of the ascending bytes.
+/// Every column encoding is prefix-free, so memcmp of the concatenation
+/// compares column by column.
+class KeyEncoder {
+ public:
+  explicit KeyEncoder(std::vector<std::byte>& out) : out_(&out) {}
+
+  template <std::integral T>
+    requires(!std::same_as<T, bool>)
+  KeyEncoder& add(T v, KeyOrder order = KeyOrder::asc) {
+    detail::put_big_endian(*out_, detail::to_ordered(v), sizeof(T), order);
+    return *this;
+  }
+
+  template <std::floating_point T>
+    requires(sizeof(T) == 4 || sizeof(T) == 8)
+  KeyEncoder& add(T v, KeyOrder order = KeyOrder::asc) {
+    using U = std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>;
+    constexpr U sign = U(1) << (8 * sizeof(T) - 1);
+    if (v != v) v = std::numeric_limits<T>::quiet_NaN();
+    if (v == 0) v = 0;  // folds -0.0 into 0.0
+    U bits = std::bit_cast<U>(v);
+    bits = (bits & sign) ? U(~bits) : U(bits | sign);
+    detail::put_big_endian(*out_, bits, sizeof(T), order);
+    return *this;
+  }
+
+  KeyEncoder& add(std::string_view s, KeyOrder order = KeyOrder::asc) {
+    const std::byte flip = order == KeyOrder::desc ? std::byte{0xFF} : std::byte{0};
+    const std::size_t at = out_->size();
+    const std::size_t zeros = static_cast<std::size_t>(std::count(s.begin(), s.end(), '\0'));
+    out_->resize(at + s.size() + zeros + 2);
+    std::byte* p = out_->data() + at;
+    for (char c : s) {
+      *p++ = static_cast<std::byte>(c) ^ flip;
+      if (c == '\0') *p++ = std::byte{0xFF} ^ flip;
+    }
+    p[0] = p[1] = flip;
+    return *this;
+  }
+
+ private:
+  std::vector<std::byte>* out_;
+};
+
+/// The normalized keys of one sorted run of records, encoded once and kept
+/// in a single arena. `encode(KeyEncoder&, const Record&)` adds the
+/// record's columns; record i gets row `first_row + i`, so runs built with
+/// disjoint row ranges can be merged and their records found again.
+///
+///   NormalizedRun run(records, [](KeyEncoder& e, const Row& r) {
+///     e.add(r.priority, KeyOrder::desc).add(r.name).add(r.score);
+///   });
+///   merge(runs_of_keys, out, NormalizedPrefixLess{});
+class NormalizedRun {
+ public:
+  NormalizedRun() = default;
+
+  template <std::ranges::input_range Records, class Encode>
+  NormalizedRun(const Records& records, Encode encode, std::uint32_t first_row = 0) {
+    std::vector<std::uint64_t> ends;
+    if constexpr (std::ranges::sized_range<Records>) ends.reserve(std::ranges::size(records));
+    KeyEncoder encoder(bytes_);
+    for (const auto& record : records) {
+      encode(encoder, record);
+      ends.push_back(bytes_.size());
+    }
+    if (ends.size() > std::numeric_limits<std::uint32_t>::max() - std::uint64_t(first_row))
+      throw std::length_error("NormalizedRun: too many records for 32-bit rows");
+    keys_.resize(ends.size());
+    std::uint64_t begin = 0;
+    for (std::size_t i = 0; i < ends.size(); ++i) {
+      const std::uint64_t size = ends[i] - begin;
+      if (size > std::numeric_limits<std::uint32_t>::max())
+        throw std::length_error("NormalizedRun: key longer than 4 GiB");
+      const std::byte* p = bytes_.data() + begin;
+      keys_[i] = {detail::load_prefix(p, size), p, static_cast<std::uint32_t>(size),
+                  static_cast<std::uint32_t>(first_row + i)};
+      begin = ends[i];
+    }
+  }
+
+  // The keys point into bytes_: moving keeps them valid, copying would not.
+  NormalizedRun(NormalizedRun&&) = default;
+  NormalizedRun& operator=(NormalizedRun&&) = default;
+  NormalizedRun(const NormalizedRun&) = delete;
+  NormalizedRun& operator=(const NormalizedRun&) = delete;
+
+  std::span<const NormalizedKey> keys() const { return keys_; }
+  std::size_t size() const { return keys_.size(); }
+
+  /// Bytes of encoded keys, excluding the NormalizedKey array.
+  std::size_t encoded_bytes() const { return bytes_.size(); }
+
+ private:
+  std::vector<std::byte> bytes_;
+  std::vector<NormalizedKey> keys_;
+};
+
+}  // namespace nway
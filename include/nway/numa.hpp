@@ -0,0 +1,187 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <sched.h>
+#include <unistd.h>
+
+#ifdef NWAY_HAVE_NUMA
+#include <numa.h>
+#include <numaif.h>
+#endif
+
+namespace nway::numa {
+
+/// Thin, best-effort wrappers over libnuma. Built without it (NWAY_HAVE_NUMA
+/// unset, see CMakeLists.txt) or on a kernel without NUMA support, every call
+/// degrades to a single-node no-op. Placement failures are not errors: they
+/// only cost locality, so the calls report them through their return value.
+
+/// Whether NUMA placement calls have any effect on this host.
+inline bool available() {
+#ifdef NWAY_HAVE_NUMA
+  static const bool ok = numa_available() >= 0;
+  return ok;
+#else
+  return false;
+#endif
+}
+
+/// Number of memory nodes, 1 when NUMA is unavailable.
+inline int nodes() {
+#ifdef NWAY_HAVE_NUMA
+  if (available()) return numa_max_node() + 1;
+#endif
+  return 1;
+}
+
+inline std::size_t page_size() {
+  static const std::size_t size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+  return size;
+}
+
+/// Node holding each page in `addrs`, or -1 where unknown (not yet faulted in,
+/// or NUMA unavailable). Does not fault pages in.
+inline std::vector<int> nodes_of(std::span<const void* const> addrs) {
+  std::vector<int> status(addrs.size(), -1);
+#ifdef NWAY_HAVE_NUMA
+  if (available() && !addrs.empty()) {
+    std::vector<void*> pages(addrs.size());
+    for (std::size_t i = 0; i < addrs.size(); ++i) {
+      const auto a = reinterpret_cast<std::uintptr_t>(addrs[i]) & ~(page_size() - 1);
+      pages[i] = reinterpret_cast<void*>(a);
+    }
+    if (numa_move_pages(0, pages.size(), pages.data(), nullptr, status.data(), 0) != 0)
+      return std::vector<int>(addrs.size(), -1);
+    for (int& s : status)
+      if (s < 0) s = -1;
+  }
+#endif
+  return status;
+}
+
+/// Pins the calling thread to the CPUs of `node` and prefers that node for
+/// its allocations.
+inline bool bind_thread(int node) {
+#ifdef NWAY_HAVE_NUMA
+  if (available() && node >= 0 && node < nodes()) {
+    numa_set_preferred(node);
+    return numa_run_on_node(node) == 0;
+  }
+#endif
+  (void)node;
+  return false;
+}
+
+namespace detail {
+
+// The whole pages inside [p, p + bytes).
+inline std::span<std::byte> inner_pages(void* p, std::size_t bytes) {
+  const auto first = (reinterpret_cast<std::uintptr_t>(p) + page_size() - 1) & ~(page_size() - 1);
+  const auto last = (reinterpret_cast<std::uintptr_t>(p) + bytes) & ~(page_size() - 1);
+  if (last <= first) return {};
+  return {reinterpret_cast<std::byte*>(first), last - first};
+}
+
+}  // namespace detail
+
+/// Prefers `node` for the whole pages of [p, p + bytes), migrating any that
+/// are already resident elsewhere. Preferred rather than bound: when `node`
+/// runs out of memory, new pages fall back to other nodes instead of failing.
+/// The policy stays on the range until reset_policy().
+inline bool place_on_node(void* p, std::size_t bytes, int node) {
+#ifdef NWAY_HAVE_NUMA
+  const auto pages = detail::inner_pages(p, bytes);
+  if (available() && !pages.empty() && node >= 0 && node < nodes()) {
+    bitmask* mask = numa_allocate_nodemask();
+    numa_bitmask_setbit(mask, static_cast<unsigned>(node));
+    const long rc = mbind(pages.data(), pages.size(), MPOL_PREFERRED, mask->maskp,
+                          mask->size + 1, MPOL_MF_MOVE);
+    numa_free_nodemask(mask);
+    return rc == 0;
+  }
+#endif
+  (void)p, (void)bytes, (void)node;
+  return false;
+}
+
+/// Spreads the whole pages of [p, p + bytes) round-robin over all nodes. The
+/// policy stays on the range until reset_policy().
+inline bool interleave(void* p, std::size_t bytes) {
+#ifdef NWAY_HAVE_NUMA
+  const auto pages = detail::inner_pages(p, bytes);
+  if (available() && !pages.empty()) {
+    return mbind(pages.data(), pages.size(), MPOL_INTERLEAVE, numa_all_nodes_ptr->maskp,
+                 numa_all_nodes_ptr->size + 1, MPOL_MF_MOVE) == 0;
+  }
+#endif
+  (void)p, (void)bytes;
+  return false;
+}
+
+/// Returns the whole pages of [p, p + bytes) to MPOL_DEFAULT. Resident pages
+/// stay on the node they were placed on; only later faults are affected.
+inline bool reset_policy(void* p, std::size_t bytes) {
+#ifdef NWAY_HAVE_NUMA
+  const auto pages = detail::inner_pages(p, bytes);
+  if (available() && !pages.empty())
+    return mbind(pages.data(), pages.size(), MPOL_DEFAULT, nullptr, 0, 0) == 0;
+#endif
+  (void)p, (void)bytes;
+  return false;
+}
+
+/// Writes one byte per page of [p, p + bytes) so that not-yet-resident pages
+/// are allocated now, by the calling thread, under the current policy. Only
+/// for memory about to be overwritten.
+inline void first_touch(void* p, std::size_t bytes) {
+  const auto first = reinterpret_cast<std::uintptr_t>(p);
+  for (auto a = first & ~(page_size() - 1); a < first + bytes; a += page_size())
+    *reinterpret_cast<volatile std::byte*>(a < first ? first : a) = std::byte{0};
+}
+
+/// bind_thread() for the lifetime of the object; the destructor restores the
+/// thread's previous CPU affinity and local allocation.
+class ScopedBind {
+ public:
+  explicit ScopedBind(int node) {
+    if (available() && sched_getaffinity(0, sizeof(saved_), &saved_) == 0) bound_ = bind_thread(node);
+  }
+  ScopedBind(ScopedBind&& other) noexcept : saved_(other.saved_), bound_(other.bound_) {
+    other.bound_ = false;
+  }
+  ScopedBind& operator=(ScopedBind&&) = delete;
+  ~ScopedBind() {
+#ifdef NWAY_HAVE_NUMA
+    if (bound_) {
+      sched_setaffinity(0, sizeof(saved_), &saved_);
+      numa_set_localalloc();
+    }
+#endif
+  }
+
+  bool bound() const { return bound_; }
+
+ private:
+  cpu_set_t saved_{};
+  bool bound_ = false;
+};
+
+/// reset_policy() on [p, p + bytes) when the object goes out of scope, so a
+/// placement made through it does not outlive the call that made it.
+class ScopedPolicy {
+ public:
+  ScopedPolicy(void* p, std::size_t bytes) : p_(p), bytes_(bytes) {}
+  ScopedPolicy(const ScopedPolicy&) = delete;
+  ScopedPolicy& operator=(const ScopedPolicy&) = delete;
+  ~ScopedPolicy() { reset_policy(p_, bytes_); }
+
+ private:
+  void* p_;
+  std::size_t bytes_;
+};
+
+}  // namespace nway::numa
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <ranges>
+#include <thread>
+#include <vector>
+
+#include "numa.hpp"
+#include "parallel_merge.hpp"
+#include "run.hpp"
+
+namespace nway {
+
+/// Where numa_parallel_merge() puts its threads and output pages.
+enum class NumaPlacement {
+  none,        ///< OS defaults: threads float, output pages land wherever first touched
+  local,       ///< threads bound to nodes, each output part on its writer's node
+  interleave,  ///< output pages spread round-robin over all nodes, threads float
+};
+
+inline const char* to_string(NumaPlacement placement) {
+  switch (placement) {
+    case NumaPlacement::local: return "local";
+    case NumaPlacement::interleave: return "interleave";
+    default: return "none";
+  }
+}
+
+namespace detail {
+
+// Pages sampled per run when estimating where the input lives.
+inline constexpr std::size_t kNumaSamplesPerRun = 8;
+
+// Input bytes per node, estimated from evenly spaced pages of every run.
+template <RunRange Runs>
+std::vector<double> input_bytes_per_node(const Runs& runs) {
+  using T = run_value_t<Runs>;
+  std::vector<double> bytes(numa::nodes(), 0.0);
+  std::vector<const void*> addrs;
+  std::vector<double> weight;
+  for (const auto& run : runs) {
+    const std::size_t n = std::ranges::size(run);
+    const std::size_t samples = std::min(n, kNumaSamplesPerRun);
+    for (std::size_t j = 0; j < samples; ++j) {
+      addrs.push_back(std::ranges::data(run) + j * n / samples);
+      weight.push_back(double(n * sizeof(T)) / double(samples));
+    }
+  }
+  const std::vector<int> where = numa::nodes_of(addrs);
+  for (std::size_t i = 0; i < where.size(); ++i)
+    if (where[i] >= 0 && where[i] < int(bytes.size())) bytes[where[i]] += weight[i];
+  return bytes;
+}
+
+// Gives each node a share of `threads` proportional to its weight (largest
+// remainder), listed node by node; round-robin when no weight is known.
+inline std::vector<int> assign_nodes(const std::vector<double>& weight, std::size_t threads) {
+  std::vector<int> node_of(threads);
+  double total = 0;
+  for (double w : weight) total += w;
+  if (total <= 0) {
+    for (std::size_t t = 0; t < threads; ++t) node_of[t] = int(t % weight.size());
+    return node_of;
+  }
+  std::vector<std::size_t> share(weight.size());
+  std::vector<std::pair<double, int>> remainder;
+  std::size_t given = 0;
+  for (std::size_t i = 0; i < weight.size(); ++i) {
+    const double exact = double(threads) * weight[i] / total;
+    share[i] = static_cast<std::size_t>(exact);
+    given += share[i];
+    remainder.emplace_back(exact - double(share[i]), int(i));
+  }
+  std::sort(remainder.begin(), remainder.end(), std::greater<>());
+  for (std::size_t r = 0; given < threads; ++r, ++given) ++share[remainder[r].second];
+  std::size_t t = 0;
+  for (std::size_t i = 0; i < share.size(); ++i)
+    for (std::size_t j = 0; j < share[i]; ++j) node_of[t++] = int(i);
+  return node_of;
+}
+
+}  // namespace detail
+
+/// parallel_merge() with NUMA placement (selection path only). With
+/// NumaPlacement::local, worker threads are spread over the nodes in
+/// proportion to how much of the input each node hosts (sampled page
+/// residency) and pinned there; before merging an output range, the worker
+/// that runs it (its owner or a thief) places and first-touches that part of
+/// `out`, so merged output stays on the writer's node. The
+/// caller's affinity is restored afterwards. NumaPlacement::interleave
+/// instead spreads the output pages over all nodes.
+///
+/// First touch only places pages that are not resident yet; resident pages
+/// are migrated with mbind(MPOL_MF_MOVE). Placement is a preference, so a
+/// full node spills to its neighbours rather than failing the allocation.
+///
+/// Side effect: while merging, the pages of `out` carry a NUMA memory policy.
+/// It is reset to MPOL_DEFAULT before returning (also on exceptions); pages
+/// already placed keep their node. Without libnuma or on a single-node host
+/// this is plain parallel_merge(). The result is identical to the sequential
+/// stable merge.
+template <RunRange Runs, std::contiguous_iterator OutputIt, class Compare = std::less<>>
+  requires std::ranges::contiguous_range<std::ranges::range_reference_t<const Runs&>>
+OutputIt numa_parallel_merge(const Runs& runs, OutputIt out, std::size_t threads = 0,
+                             NumaPlacement placement = NumaPlacement::local,
+                             Compare comp = Compare()) {
+  using T = std::iter_value_t<OutputIt>;
+  std::size_t total = 0;
+  for (const auto& run : runs) total += std::ranges::size(run);
+  if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+  threads = std::clamp<std::size_t>(total / kMinParallelSlice, 1, threads);
+
+  T* first = std::to_address(out);
+  std::optional<numa::ScopedPolicy> policy;
+  if (placement != NumaPlacement::none) policy.emplace(first, total * sizeof(T));
+  if (placement == NumaPlacement::interleave) numa::interleave(first, total * sizeof(T));
+  std::vector<int> node_of;
+  if (placement == NumaPlacement::local)
+    node_of = detail::assign_nodes(detail::input_bytes_per_node(runs), threads);
+
+  const std::size_t tasks = detail::parallel_task_count(total, threads, kTasksPerThread);
+  return detail::parallel_merge_ranks(
+      runs, out, total, threads, tasks, comp,
+      [&](std::size_t w) {
+        std::optional<numa::ScopedBind> bind;
+        if (placement == NumaPlacement::local) bind.emplace(node_of[w]);
+        return bind;
+      },
+      [&](std::size_t w, std::size_t lo, std::size_t hi) {
+        if (placement != NumaPlacement::local) return;
+        numa::place_on_node(first + lo, (hi - lo) * sizeof(T), node_of[w]);
+        numa::first_touch(first + lo, (hi - lo) * sizeof(T));
+      });
+}
+
+}  // namespace nway
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+
+#include "detail/bitpack.hpp"
+#include "detail/file.hpp"
+#include "simd_merge.hpp"
+
+namespace nway {
+
+/// Unsigned key types the packed run format supports.
+template <class T>
+inline constexpr bool is_packed_key_v = detail::is_packed_key_v<T>;
+
+namespace detail {
+
+// Decodes one block with the AVX2 kernel when the CPU has it.
+template <class T>
+void unpack_block(const PackedHeader& h, const T* payload, T* out, SimdLevel level) {
+#ifdef NWAY_HAVE_X86_BITPACK
+  if (level >= SimdLevel::avx2) return avx2::unpack_block(h, payload, out);
+#endif
+  (void)level;
+  unpack_block_scalar(h, payload, out);
+}
+
+}  // namespace detail
+
+/// Writer of a compressed run of unsigned keys: blocks of
+/// detail::kPackedBlock keys, each stored as the gaps between neighbours
+/// minus the block's smallest gap, bit-packed at the width of the largest
+/// remainder (detail/bitpack.hpp). A sorted run of N random 64-bit keys
+/// costs about 64 - log2(N) + 2 bits per key instead of 64. Keys need not be
+/// sorted, they only compress worse. Same interface as RunWriter; finish()
+/// must be called to flush.
+template <class T>
+  requires is_packed_key_v<T>
+class PackedRunWriter {
+ public:
+  PackedRunWriter(const std::filesystem::path& path, std::size_t buffer_bytes)
+      : file_(detail::File::create(path)),
+        cap_(std::max(buffer_bytes, 2 * detail::packed_block_bound<T>())),
+        buf_(new std::uint64_t[(cap_ + 7) / 8]) {}
+
+  /// Bytes a writer built with `buffer_bytes` holds: the encode buffer and
+  /// the block being gathered.
+  static std::size_t footprint(std::size_t buffer_bytes) {
+    return (std::max(buffer_bytes, 2 * detail::packed_block_bound<T>()) + 7) / 8 * 8 +
+           detail::kPackedBlock * sizeof(T);
+  }
+
+  void push(const T& value) {
+    block_[n_++] = value;
+    if (n_ == detail::kPackedBlock) pack();
+  }
+
+  void write(const T* data, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) push(data[i]);
+  }
+
+  void finish() {
+    if (n_ > 0) pack();
+    flush();
+    file_.close();
+  }
+
+  /// Compressed bytes so far; exact after finish().
+  std::uint64_t bytes_written() const { return written_ + len_; }
+
+ private:
+  void pack() {
+    if (len_ + detail::packed_block_bound<T>() > cap_) flush();
+    len_ += detail::pack_block(block_, n_, bytes() + len_);
+    n_ = 0;
+  }
+
+  void flush() {
+    if (len_ == 0) return;
+    file_.write(bytes(), len_);
+    written_ += len_;
+    len_ = 0;
+  }
+
+  std::byte* bytes() { return reinterpret_cast<std::byte*>(buf_.get()); }
+
+  detail::File file_;
+  std::size_t cap_;
+  std::unique_ptr<std::uint64_t[]> buf_;  // 8-byte aligned, so payloads are too
+  std::size_t len_ = 0;
+  std::uint64_t written_ = 0;
+  T block_[detail::kPackedBlock];
+  std::size_t n_ = 0;
+};
+
+/// Sequential reader of a PackedRunWriter file, with the cursor interface of
+/// RunReader (empty/front/pop). Reads `buffer_bytes` of compressed data at a
+/// time and decodes one block at a time, with AVX2 when available.
+template <class T>
+  requires is_packed_key_v<T>
+class PackedRunReader {
+ public:
+  PackedRunReader(const std::filesystem::path& path, std::size_t buffer_bytes,
+                  SimdLevel level = simd_level())
+      : file_(detail::File::open_read(path)),
+        cap_(std::max(buffer_bytes, 2 * detail::packed_block_bound<T>()) / 8 * 8),
+        buf_(new std::uint64_t[cap_ / 8]),
+        level_(std::min(level, simd_level())) {
+    next_block();
+  }
+
+  bool empty() const { return pos_ == len_; }
+  const T& front() const { return keys_[pos_]; }
+  void pop() {
+    if (++pos_ == len_) next_block();
+  }
+
+  /// Compressed bytes fetched from the file so far.
+  std::uint64_t bytes_read() const { return bytes_read_; }
+
+ private:
+  void next_block() {
+    pos_ = len_ = 0;
+    if (!fill(sizeof(detail::PackedHeader))) return;
+    detail::PackedHeader h;
+    std::memcpy(&h, bytes() + begin_, sizeof h);
+    const std::size_t payload = detail::PackedLayout<T>::words(h.count, h.bits) * sizeof(T);
+    if (h.count == 0 || h.count > detail::kPackedBlock || h.bits > 8 * sizeof(T) ||
+        !fill(sizeof h + payload))
+      throw std::runtime_error("corrupt packed block in " + file_.path().string());
+    detail::unpack_block(h, reinterpret_cast<const T*>(bytes() + begin_ + sizeof h), keys_, level_);
+    begin_ += sizeof h + payload;
+    len_ = h.count;
+  }
+
+  // Makes `n` bytes available at begin_; false at a clean end of file.
+  bool fill(std::size_t n) {
+    if (end_ - begin_ >= n) return true;
+    std::memmove(bytes(), bytes() + begin_, end_ - begin_);
+    end_ -= begin_;
+    begin_ = 0;
+    const std::size_t got = file_.read(bytes() + end_, cap_ - end_);
+    end_ += got;
+    bytes_read_ += got;
+    if (end_ >= n) return true;
+    if (end_ == 0) return false;
+    throw std::runtime_error("truncated packed block in " + file_.path().string());
+  }
+
+  std::byte* bytes() { return reinterpret_cast<std::byte*>(buf_.get()); }
+
+  detail::File file_;
+  std::size_t cap_;
+  std::unique_ptr<std::uint64_t[]> buf_;
+  std::size_t begin_ = 0, end_ = 0;
+  std::uint64_t bytes_read_ = 0;
+  SimdLevel level_;
+  T keys_[detail::kPackedBlock];
+  std::size_t pos_ = 0, len_ = 0;
+};
+
+}  // namespace nway
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <ranges>
+#include <thread>
+#include <vector>
+
+#include "detail/ordered_key.hpp"
+#include "loser_tree.hpp"
+#include "multiway_select.hpp"
+#include "radix_merge.hpp"
+#include "run.hpp"
+#include "work_stealing.hpp"
+
+namespace nway {
+
+/// Smallest output slice worth handing to its own thread.
+inline constexpr std::size_t kMinParallelSlice = std::size_t(1) << 14;
+
+/// Output ranges per thread in parallel_merge(), so that stealing has
+/// something to take.
+inline constexpr std::size_t kTasksPerThread = 8;
+
+struct ParallelMergeOptions {
+  std::size_t threads = 0;  ///< 0: all cores
+  std::size_t tasks_per_thread = kTasksPerThread;
+  WorkStealingStats* stats = nullptr;  ///< filled in when not null
+};
+
+/// Merges the [begin[i], end[i]) slice of every run into `out`.
+template <RunRange Runs, class OutputIt, class Compare>
+OutputIt merge_slices(const Runs& runs, const std::vector<std::size_t>& begin,
+                      const std::vector<std::size_t>& end, OutputIt out, Compare comp) {
+  using It = std::ranges::iterator_t<const std::ranges::range_value_t<Runs>>;
+  std::vector<std::ranges::subrange<It>> slices;
+  slices.reserve(begin.size());
+  for (std::size_t i = 0; i < begin.size(); ++i) {
+    const auto first = std::ranges::begin(runs[i]);
+    slices.emplace_back(first + begin[i], first + end[i]);
+  }
+  return loser_tree_merge(slices, out, std::move(comp));
+}
+
+namespace detail {
+
+// Cuts the output into `tasks` equal rank ranges and merges them on `threads`
+// work-stealing workers (worker 0 is the caller). Each task locates its range
+// in every run with multiway_select(). `on_start(worker)` runs once per worker
+// and its result lives until the worker is done; `on_task(worker, first,
+// last)` runs before the worker merges output ranks [first, last).
+template <RunRange Runs, std::random_access_iterator OutputIt, class Compare, class OnStart,
+          class OnTask>
+OutputIt parallel_merge_ranks(const Runs& runs, OutputIt out, std::size_t total,
+                              std::size_t threads, std::size_t tasks, Compare& comp,
+                              OnStart on_start, OnTask on_task,
+                              WorkStealingStats* stats = nullptr) {
+  work_stealing_for(
+      tasks, threads,
+      [&](std::size_t w, std::size_t i) {
+        const std::size_t first = total * i / tasks, last = total * (i + 1) / tasks;
+        on_task(w, first, last);
+        auto begin = multiway_select(runs, first, comp);
+        auto end = multiway_select(runs, last, comp);
+        merge_slices(runs, begin, end, out + first, comp);
+      },
+      on_start, stats);
+  return out + total;
+}
+
+// Task count for `threads` workers: tasks_per_thread each, but no task below
+// kMinParallelSlice elements unless that leaves fewer tasks than threads.
+inline std::size_t parallel_task_count(std::size_t total, std::size_t threads,
+                                       std::size_t tasks_per_thread) {
+  const std::size_t most = std::max(threads, total / kMinParallelSlice);
+  return std::clamp(threads * std::max<std::size_t>(tasks_per_thread, 1), threads, most);
+}
+
+}  // namespace detail
+
+/// Parallel K-way merge. The output is cut into threads x tasks_per_thread
+/// equal rank ranges; a task locates its range in every run with
+/// multiway_select() and merges it independently into its own disjoint part
+/// of `out`. Tasks run on a work-stealing pool (work_stealing.hpp): a worker
+/// that finishes early takes over the back half of a slower worker's
+/// remaining ranges, which evens out comparators of variable cost or inputs
+/// that are slow to page in. `tasks_per_thread == 1` is a static split. The
+/// result is identical to the sequential stable merge.
+///
+/// Integer keys in natural order whose sampled histogram is close to uniform
+/// (radix_balanced()) go to radix_merge() instead, which partitions by the
+/// top key bits and skips the selection step. `stats` is only filled when
+/// the work-stealing path runs.
+template <RunRange Runs, std::random_access_iterator OutputIt, class Compare = std::less<>>
+OutputIt parallel_merge(const Runs& runs, OutputIt out, const ParallelMergeOptions& opts,
+                        Compare comp = Compare()) {
+  std::size_t total = 0;
+  for (const auto& run : runs) total += std::ranges::size(run);
+  std::size_t threads = opts.threads;
+  if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+  threads = std::clamp<std::size_t>(total / kMinParallelSlice, 1, threads);
+  if (threads == 1) return loser_tree_merge(runs, out, std::move(comp));
+  if constexpr (detail::is_ordered_int_key_v<run_value_t<Runs>, Compare>) {
+    if (radix_balanced(runs, 4 * threads)) return radix_merge(runs, out, threads, 4 * threads);
+  }
+  const std::size_t tasks = detail::parallel_task_count(total, threads, opts.tasks_per_thread);
+  return detail::parallel_merge_ranks(
+      runs, out, total, threads, tasks, comp, [](std::size_t) { return 0; },
+      [](std::size_t, std::size_t, std::size_t) {}, opts.stats);
+}
+
+/// parallel_merge() on `threads` workers (0: all cores) with default options.
+template <RunRange Runs, std::random_access_iterator OutputIt, class Compare = std::less<>>
+OutputIt parallel_merge(const Runs& runs, OutputIt out, std::size_t threads = 0,
+                        Compare comp = Compare()) {
+  return parallel_merge(runs, out, ParallelMergeOptions{.threads = threads}, std::move(comp));
+}
+
+}  // namespace nway
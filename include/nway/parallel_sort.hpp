@@ -0,0 +1,65 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "parallel_merge.hpp"
+#include "work_stealing.hpp"
+
+namespace nway {
+
+/// Sorts `data` in place as one piece per worker on `threads` workers (0: all
+/// cores), each piece with std::sort, and returns the sorted pieces in order.
+/// Data too small to split (below two kMinParallelSlice pieces) comes back as
+/// a single piece sorted on the calling thread. Combining the pieces is left
+/// to the caller, so no scratch is needed: parallel_sort() merges them into a
+/// buffer, external_sort() streams them through a merge into its spill writer.
+template <class T, class Compare = std::less<>>
+std::vector<std::span<const T>> parallel_sort_pieces(std::span<T> data, std::size_t threads = 0,
+                                                     Compare comp = Compare()) {
+  const std::size_t n = data.size();
+  if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+  const std::size_t pieces = std::clamp<std::size_t>(n / kMinParallelSlice, 1, threads);
+  if (pieces == 1) {
+    std::sort(data.begin(), data.end(), comp);
+    return {std::span<const T>(data)};
+  }
+
+  std::vector<std::span<const T>> runs(pieces);
+  for (std::size_t p = 0; p < pieces; ++p)
+    runs[p] = data.subspan(n * p / pieces, n * (p + 1) / pieces - n * p / pieces);
+  work_stealing_for(
+      pieces, pieces,
+      [&](std::size_t, std::size_t p) {
+        const auto first = data.begin() + (n * p / pieces);
+        std::sort(first, first + runs[p].size(), comp);
+      },
+      [](std::size_t) { return 0; });
+  return runs;
+}
+
+/// Sorts `data` on `threads` workers (0: all cores). The data is cut into one
+/// piece per worker, each piece is sorted with std::sort, and the pieces are
+/// combined by parallel_merge() into `scratch`, which must be at least as
+/// large as `data`. Returns the span holding the result: `data` itself when
+/// it was too small to split (below two kMinParallelSlice pieces), otherwise
+/// the front of `scratch`. Not stable.
+template <class T, class Compare = std::less<>>
+std::span<T> parallel_sort(std::span<T> data, std::span<T> scratch, std::size_t threads = 0,
+                           Compare comp = Compare()) {
+  const std::size_t n = data.size();
+  if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+  if (std::clamp<std::size_t>(n / kMinParallelSlice, 1, threads) > 1 && scratch.size() < n)
+    throw std::invalid_argument("parallel_sort: scratch smaller than data");
+  const std::vector<std::span<const T>> runs = parallel_sort_pieces(data, threads, comp);
+  if (runs.size() == 1) return data;
+  parallel_merge(runs, scratch.data(), runs.size(), comp);
+  return scratch.first(n);
+}
+
+}  // namespace nway
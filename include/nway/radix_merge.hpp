@@ -0,0 +1,157 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <ranges>
+#include <thread>
+#include <vector>
+
+#include "detail/ordered_key.hpp"
+#include "merge.hpp"
+#include "run.hpp"
+
+namespace nway {
+
+/// Evenly spaced keys sampled per run for the radix_balanced() histogram.
+inline constexpr std::size_t kRadixSamples = 64;
+
+/// Largest estimated bucket size, relative to the mean, for which
+/// radix_balanced() still calls the key distribution uniform.
+inline constexpr double kRadixMaxSkew = 2.0;
+
+namespace detail {
+
+// Maps an ordered key word to its bucket: the top bits of its offset from the
+// smallest key, so the buckets cut [lo, hi] into equal key intervals.
+struct RadixBuckets {
+  std::uint64_t lo = 0;
+  int shift = 0;
+  std::size_t count = 1;
+
+  std::size_t operator()(std::uint64_t w) const { return static_cast<std::size_t>((w - lo) >> shift); }
+};
+
+// Splits the key range of `runs` into at most `buckets` (a power of two,
+// at least 2) intervals; fewer when the range is narrower than that.
+template <RunRange Runs>
+RadixBuckets radix_buckets(const Runs& runs, std::size_t buckets) {
+  std::uint64_t lo = std::numeric_limits<std::uint64_t>::max(), hi = 0;
+  for (const auto& run : runs) {
+    if (std::ranges::empty(run)) continue;
+    lo = std::min(lo, to_ordered(run[0]));
+    hi = std::max(hi, to_ordered(run[std::ranges::size(run) - 1]));
+  }
+  if (lo > hi) return {};
+  RadixBuckets b;
+  b.lo = lo;
+  b.shift = std::max(0, int(std::bit_width(hi - lo)) - std::countr_zero(buckets));
+  b.count = b(hi) + 1;
+  return b;
+}
+
+}  // namespace detail
+
+/// Whether the top key bits split `runs` into `buckets` parts of roughly equal
+/// size, judged from a histogram of kRadixSamples evenly spaced keys per run
+/// (each weighted by its run's length): no bucket may exceed kRadixMaxSkew
+/// times the mean over the buckets the key range actually reaches. Costs O(K kRadixSamples) and reads no more of the runs.
+template <RunRange Runs>
+  requires detail::is_ordered_int_key_v<run_value_t<Runs>, std::less<>>
+bool radix_balanced(const Runs& runs, std::size_t buckets) {
+  buckets = std::bit_ceil(std::max<std::size_t>(buckets, 2));
+  const detail::RadixBuckets bucket = detail::radix_buckets(runs, buckets);
+  // The buckets span [lo, lo + 2^(shift + log2 buckets)), so a range short of a
+  // power of two leaves the top ones empty; only a range too narrow to split
+  // at all is rejected here, the skew is judged on the buckets in use.
+  if (2 * bucket.count <= buckets) return false;
+  std::vector<double> hist(bucket.count, 0.0);
+  double total = 0;
+  for (const auto& run : runs) {
+    const std::size_t n = std::ranges::size(run);
+    const std::size_t samples = std::min(n, kRadixSamples);
+    for (std::size_t j = 0; j < samples; ++j)
+      hist[bucket(detail::to_ordered(run[j * n / samples]))] += double(n) / double(samples);
+    total += double(n);
+  }
+  const double limit = kRadixMaxSkew * total / double(bucket.count);
+  return std::ranges::all_of(hist, [&](double h) { return h <= limit; });
+}
+
+/// Radix-partitioned parallel merge for integer keys in ascending order. The
+/// key range is cut by its top bits into `buckets` equal intervals; since the
+/// runs are sorted, each run splits into contiguous per-bucket slices with one
+/// binary search per boundary and no data movement. Every bucket is then an
+/// independent K-way merge (nway::merge) into its own part of `out`, taken by
+/// `threads` workers from a shared counter; no multi-sequence selection is
+/// needed and the output equals the sequential stable merge.
+///
+/// Load balance depends on the keys being spread evenly over their range;
+/// parallel_merge() checks that with radix_balanced() before choosing this.
+/// `threads == 0` uses all cores; `buckets == 0` picks 4 per thread.
+template <RunRange Runs, std::random_access_iterator OutputIt>
+  requires detail::is_ordered_int_key_v<run_value_t<Runs>, std::less<>>
+OutputIt radix_merge(const Runs& runs, OutputIt out, std::size_t threads = 0,
+                     std::size_t buckets = 0) {
+  const std::size_t k = std::ranges::size(runs);
+  if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+  if (buckets == 0) buckets = 4 * threads;
+  const detail::RadixBuckets bucket =
+      detail::radix_buckets(runs, std::bit_ceil(std::max<std::size_t>(buckets, 2)));
+  const std::size_t nb = bucket.count;
+
+  // bounds[b * k + i]: start of bucket b in run i; offsets[b]: its start in `out`.
+  std::vector<std::size_t> bounds((nb + 1) * k), offsets(nb + 1, 0);
+  for (std::size_t i = 0; i < k; ++i) {
+    const auto first = std::ranges::begin(runs[i]);
+    const std::size_t n = std::ranges::size(runs[i]);
+    std::size_t from = 0;
+    for (std::size_t b = 1; b < nb; ++b) {
+      from = static_cast<std::size_t>(
+          std::partition_point(first + from, first + n,
+                               [&](const auto& x) { return bucket(detail::to_ordered(x)) < b; }) -
+          first);
+      bounds[b * k + i] = from;
+    }
+    bounds[nb * k + i] = n;
+  }
+  for (std::size_t b = 0; b < nb; ++b) {
+    offsets[b + 1] = offsets[b];
+    for (std::size_t i = 0; i < k; ++i) offsets[b + 1] += bounds[(b + 1) * k + i] - bounds[b * k + i];
+  }
+
+  using It = std::ranges::iterator_t<const std::ranges::range_value_t<Runs>>;
+  std::atomic<std::size_t> next{0};
+  threads = std::min(threads, nb);
+  std::vector<std::exception_ptr> errors(threads);
+  auto work = [&](std::size_t t) {
+    try {
+      std::vector<std::ranges::subrange<It>> slices(k);
+      for (std::size_t b; (b = next.fetch_add(1, std::memory_order_relaxed)) < nb;) {
+        for (std::size_t i = 0; i < k; ++i) {
+          const auto first = std::ranges::begin(runs[i]);
+          slices[i] = {first + bounds[b * k + i], first + bounds[(b + 1) * k + i]};
+        }
+        merge(slices, out + offsets[b]);
+      }
+    } catch (...) {
+      errors[t] = std::current_exception();
+    }
+  };
+  std::vector<std::thread> pool;
+  pool.reserve(threads - 1);
+  for (std::size_t t = 1; t < threads; ++t) pool.emplace_back(work, t);
+  work(0);
+  for (auto& th : pool) th.join();
+  for (auto& e : errors)
+    if (e) std::rethrow_exception(e);
+  return out + offsets[nb];
+}
+
+}  // namespace nway
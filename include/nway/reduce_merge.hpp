@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "loser_tree.hpp"
+#include "merge_view.hpp"
+#include "run.hpp"
+
+namespace nway {
+
+/// Merges the sorted runs and folds every group of equivalent elements
+/// (neither compares less than the other) into one as they meet, e.g. summing
+/// the counts of equal keys in (key, count) lists. `combine(acc, x)` folds `x`
+/// into `acc` and must leave acc's sort position unchanged. Elements are
+/// folded in stable merge order: within a group, lower runs first.
+///
+/// One pass, no intermediate buffer: `out` receives one element per distinct
+/// key and the returned iterator marks the end of the reduced output.
+template <RunRange Runs, class OutputIt, class Combine, class Compare = std::less<>>
+OutputIt reduce_merge(const Runs& runs, OutputIt out, Combine combine, Compare comp = Compare()) {
+  using T = run_value_t<Runs>;
+  const std::size_t k = std::ranges::size(runs);
+  LoserTree<T, Compare> tree(comp);
+  tree.reset(k);
+  std::vector<std::size_t> pos(k, 0);
+  for (std::size_t i = 0; i < k; ++i) {
+    if (!std::ranges::empty(runs[i])) {
+      tree.set(i, runs[i][0]);
+      pos[i] = 1;
+    }
+  }
+  tree.build();
+  const auto advance = [&] {
+    const std::size_t s = tree.top_leaf();
+    if (pos[s] < std::ranges::size(runs[s]))
+      tree.replace_top(runs[s][pos[s]++]);
+    else
+      tree.retire_top();
+  };
+  if (tree.empty()) return out;
+  T acc = tree.top();
+  advance();
+  while (!tree.empty()) {
+    if (comp(acc, tree.top())) {
+      *out++ = std::move(acc);
+      acc = tree.top();
+    } else {
+      combine(acc, tree.top());
+    }
+    advance();
+  }
+  *out++ = std::move(acc);
+  return out;
+}
+
+/// Streaming reduce_merge: a merge_view whose output has one element per
+/// distinct key, the fold of all equivalent elements across the inputs.
+/// Holds one accumulator on top of the merge_view's O(K) state. Single pass.
+template <std::ranges::input_range Input, class Combine, class Compare = std::less<>>
+  requires std::ranges::view<Input>
+class merge_reduce_view
+    : public std::ranges::view_interface<merge_reduce_view<Input, Combine, Compare>> {
+ public:
+  using value_type = std::ranges::range_value_t<Input>;
+
+  class iterator {
+   public:
+    using value_type = merge_reduce_view::value_type;
+    using difference_type = std::ptrdiff_t;
+    using iterator_concept = std::input_iterator_tag;
+
+    iterator() = default;
+
+    const value_type& operator*() const { return *parent_->acc_; }
+    iterator& operator++() {
+      parent_->pull();
+      return *this;
+    }
+    void operator++(int) { ++*this; }
+
+    friend bool operator==(const iterator& it, std::default_sentinel_t) { return it.at_end(); }
+
+   private:
+    friend merge_reduce_view;
+    explicit iterator(merge_reduce_view* parent) : parent_(parent) {}
+    bool at_end() const { return !parent_->acc_; }
+    merge_reduce_view* parent_ = nullptr;
+  };
+
+  merge_reduce_view() = default;
+  merge_reduce_view(std::vector<Input> inputs, Combine combine, Compare comp = Compare())
+      : merged_(std::move(inputs), comp), combine_(std::move(combine)), comp_(std::move(comp)) {}
+
+  iterator begin() {
+    it_ = merged_.begin();
+    pull();
+    return iterator(this);
+  }
+  std::default_sentinel_t end() const { return {}; }
+
+ private:
+  void pull() {
+    if (it_ == std::default_sentinel) {
+      acc_.reset();
+      return;
+    }
+    acc_ = *it_;
+    while (++it_ != std::default_sentinel && !comp_(*acc_, *it_)) combine_(*acc_, *it_);
+  }
+
+  merge_view<Input, Compare> merged_;
+  std::ranges::iterator_t<merge_view<Input, Compare>> it_;
+  std::optional<value_type> acc_;
+  Combine combine_;
+  Compare comp_;
+};
+
+namespace views {
+
+/// `nway::views::merge_reduce(inputs, combine[, comp])`: a merge_reduce_view
+/// over every range in `inputs`, with the same lvalue/rvalue rules as
+/// views::merge.
+struct MergeReduceFn {
+  template <std::ranges::input_range Inputs, class Combine, class Compare = std::less<>>
+    requires std::ranges::input_range<std::ranges::range_reference_t<Inputs>>
+  auto operator()(Inputs&& inputs, Combine combine, Compare comp = Compare()) const {
+    using Ref = std::conditional_t<std::is_lvalue_reference_v<Inputs>,
+                                   std::ranges::range_reference_t<Inputs>,
+                                   std::ranges::range_rvalue_reference_t<Inputs>>;
+    using Input = std::views::all_t<Ref>;
+    std::vector<Input> all;
+    for (auto&& input : inputs) all.push_back(std::views::all(static_cast<Ref>(input)));
+    return merge_reduce_view<Input, Combine, Compare>(std::move(all), std::move(combine),
+                                                      std::move(comp));
+  }
+};
+
+inline constexpr MergeReduceFn merge_reduce;
+
+}  // namespace views
+
+}  // namespace nway
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <ranges>
+
+namespace nway {
+
+/// A collection of sorted inputs ("runs") addressable by index, e.g.
+/// `std::vector<std::vector<T>>` or `std::vector<std::span<const T>>`.
+template <class Runs>
+concept RunRange = std::ranges::random_access_range<Runs> &&
+                   std::ranges::random_access_range<std::ranges::range_reference_t<Runs>>;
+
+template <class Runs>
+using run_value_t = std::ranges::range_value_t<std::ranges::range_reference_t<Runs>>;
+
+}  // namespace nway
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+
+#include "detail/file.hpp"
+
+namespace nway {
+
+/// Sequential reader over a file of raw `T` records through a fixed buffer.
+/// Also a single-pass input range, e.g. for nway::views::merge.
+template <class T>
+class RunReader {
+  static_assert(std::is_trivially_copyable_v<T>, "run records must be trivially copyable");
+
+ public:
+  class iterator {
+   public:
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using iterator_concept = std::input_iterator_tag;
+
+    iterator() = default;
+    explicit iterator(RunReader* reader) : reader_(reader) {}
+
+    const T& operator*() const { return reader_->front(); }
+    iterator& operator++() {
+      reader_->pop();
+      return *this;
+    }
+    void operator++(int) { reader_->pop(); }
+    friend bool operator==(const iterator& it, std::default_sentinel_t) {
+      return it.reader_->empty();
+    }
+
+   private:
+    RunReader* reader_ = nullptr;
+  };
+
+  RunReader(const std::filesystem::path& path, std::size_t buffer_bytes)
+      : file_(detail::File::open_read(path)),
+        cap_(std::max<std::size_t>(1, buffer_bytes / sizeof(T))),
+        buf_(new T[cap_]) {
+    refill();
+  }
+
+  bool empty() const { return pos_ == len_; }
+  const T& front() const { return buf_[pos_]; }
+  void pop() {
+    if (++pos_ == len_) refill();
+  }
+
+  iterator begin() { return iterator(this); }
+  std::default_sentinel_t end() const { return {}; }
+
+  /// Bytes fetched from the file so far.
+  std::uint64_t bytes_read() const { return bytes_read_; }
+
+ private:
+  void refill() {
+    std::size_t bytes = file_.read(buf_.get(), cap_ * sizeof(T));
+    bytes_read_ += bytes;
+    if (bytes % sizeof(T) != 0)
+      throw std::runtime_error("truncated record in " + file_.path().string());
+    pos_ = 0;
+    len_ = bytes / sizeof(T);
+  }
+
+  detail::File file_;
+  std::size_t cap_;
+  std::unique_ptr<T[]> buf_;
+  std::size_t pos_ = 0;
+  std::size_t len_ = 0;
+  std::uint64_t bytes_read_ = 0;
+};
+
+/// Buffered writer of raw `T` records. finish() must be called to flush.
+template <class T>
+class RunWriter {
+  static_assert(std::is_trivially_copyable_v<T>, "run records must be trivially copyable");
+
+ public:
+  RunWriter(const std::filesystem::path& path, std::size_t buffer_bytes)
+      : file_(detail::File::create(path)),
+        cap_(std::max<std::size_t>(1, buffer_bytes / sizeof(T))),
+        buf_(new T[cap_]) {}
+
+  /// Bytes of buffer a writer built with `buffer_bytes` holds.
+  static std::size_t footprint(std::size_t buffer_bytes) {
+    return std::max<std::size_t>(1, buffer_bytes / sizeof(T)) * sizeof(T);
+  }
+
+  void push(const T& value) {
+    buf_[len_++] = value;
+    if (len_ == cap_) flush();
+  }
+
+  /// Writes a block straight to the file, bypassing the buffer.
+  void write(const T* data, std::size_t n) {
+    flush();
+    file_.write(data, n * sizeof(T));
+    written_ += n * sizeof(T);
+  }
+
+  void finish() {
+    flush();
+    file_.close();
+  }
+
+  std::uint64_t bytes_written() const { return written_ + len_ * sizeof(T); }
+
+ private:
+  void flush() {
+    if (len_ == 0) return;
+    file_.write(buf_.get(), len_ * sizeof(T));
+    written_ += len_ * sizeof(T);
+    len_ = 0;
+  }
+
+  detail::File file_;
+  std::size_t cap_;
+  std::unique_ptr<T[]> buf_;
+  std::size_t len_ = 0;
+  std::uint64_t written_ = 0;
+};
+
+/// Scratch directory for spilled runs, removed with its contents on destruction.
+class TempDir {
+ public:
+  explicit TempDir(std::filesystem::path parent = {}) {
+    if (parent.empty()) parent = std::filesystem::temp_directory_path();
+    static std::atomic<unsigned> counter{0};
+    path_ = parent / ("nway-" + std::to_string(::getpid()) + "-" + std::to_string(counter++));
+    std::filesystem::create_directories(path_);
+  }
+  TempDir(const TempDir&) = delete;
+  TempDir& operator=(const TempDir&) = delete;
+  ~TempDir() {
+    std::error_code ec;
+    std::filesystem::remove_all(path_, ec);
+  }
+
+  const std::filesystem::path& path() const { return path_; }
+
+  /// Fresh file name inside the directory.
+  std::filesystem::path next_file(const char* suffix = ".run") {
+    return path_ / ("run-" + std::to_string(next_++) + suffix);
+  }
+
+ private:
+  std::filesystem::path path_;
+  std::size_t next_ = 0;
+};
+
+}  // namespace nway
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "detail/aligned_allocator.hpp"
+#include "run.hpp"
+
+namespace nway {
+
+/// Loser tree whose exhausted leaves hold a sentinel key instead of a "dead"
+/// flag, so matches need no liveness tests and replay is branch-free: each
+/// level is one comparison feeding conditional moves. Nodes carry the loser's
+/// key next to its rank, so a replay never indirects into a leaf array.
+///
+/// A leaf's rank is its index while live and K + index once retired, and ties
+/// go to the lower rank: a retired leaf loses every match against a live one
+/// even if a real key equals the sentinel. The tree has no notion of empty;
+/// callers stop after emitting the known element count.
+template <class T, class Compare = std::less<>>
+class BranchlessLoserTree {
+ public:
+  using Index = std::uint32_t;
+
+  explicit BranchlessLoserTree(Compare comp = Compare()) : comp_(std::move(comp)) {}
+
+  /// Resizes to `k` leaves, all holding `sentinel` (retired).
+  void reset(std::size_t k, const T& sentinel) {
+    k_ = static_cast<Index>(k);
+    nodes_.assign(k == 0 ? 1 : k, Node{sentinel, 0});
+    win_.resize(2 * k);
+    for (Index i = 0; i < k_; ++i) win_[k_ + i] = Node{sentinel, k_ + i};
+  }
+
+  void set(std::size_t leaf, T key) {
+    win_[k_ + leaf] = Node{std::move(key), static_cast<Index>(leaf)};
+  }
+
+  void build() {
+    if (k_ == 0) return;
+    for (Index n = k_ - 1; n > 0; --n) {
+      const Node& a = win_[2 * n];
+      const Node& b = win_[2 * n + 1];
+      const bool ab = beats(a, b);
+      nodes_[n] = ab ? b : a;
+      win_[n] = ab ? a : b;
+    }
+    nodes_[0] = win_[1];
+  }
+
+  std::size_t top_leaf() const { return nodes_[0].rank; }
+  const T& top() const { return nodes_[0].key; }
+
+  /// Gives the winning leaf its next key, or the sentinel when `live` is
+  /// false; either way without branching.
+  void advance_top(const T& key, bool live) {
+    const Index w = nodes_[0].rank;
+    Node cur{key, live ? w : k_ + w};
+    for (Index n = (w + k_) >> 1; n > 0; n >>= 1) {
+      const Node loser = nodes_[n];
+      const bool swap = beats(loser, cur);
+      nodes_[n] = swap ? cur : loser;
+      cur = swap ? loser : cur;
+    }
+    nodes_[0] = cur;
+  }
+
+ private:
+  struct Node {
+    T key;
+    Index rank;
+  };
+
+  // Strict (key, rank) order with one call to comp_: the operands are
+  // selected first, then the result is flipped when a has the lower rank.
+  bool beats(const Node& a, const Node& b) const {
+    const bool lower = a.rank < b.rank;
+    const T& x = lower ? b.key : a.key;
+    const T& y = lower ? a.key : b.key;
+    return lower != comp_(x, y);
+  }
+
+  Compare comp_;
+  Index k_ = 0;
+  std::vector<Node, detail::AlignedAllocator<Node>> nodes_;
+  std::vector<Node> win_;
+};
+
+/// Loser tree merge without per-element bounds checks: an exhausted run reads
+/// as `sentinel`, which must compare not less than every key, and the loop
+/// runs for exactly the total element count. Contiguous runs only. Stable.
+template <RunRange Runs, class OutputIt, class Compare = std::less<>>
+  requires std::ranges::contiguous_range<std::ranges::range_reference_t<const Runs&>>
+OutputIt sentinel_merge(const Runs& runs, OutputIt out, const run_value_t<Runs>& sentinel,
+                        Compare comp = Compare()) {
+  using T = run_value_t<Runs>;
+  const std::size_t k = std::ranges::size(runs);
+  BranchlessLoserTree<T, Compare> tree(std::move(comp));
+  tree.reset(k, sentinel);
+  std::vector<const T*> cur(k), end(k);
+  std::size_t total = 0;
+  for (std::size_t i = 0; i < k; ++i) {
+    cur[i] = std::ranges::data(runs[i]);
+    end[i] = cur[i] + std::ranges::size(runs[i]);
+    total += std::ranges::size(runs[i]);
+    if (cur[i] != end[i]) tree.set(i, *cur[i]);
+  }
+  tree.build();
+  for (std::size_t n = 0; n < total; ++n) {
+    const std::size_t w = tree.top_leaf();
+    *out++ = tree.top();
+    const bool live = ++cur[w] != end[w];
+    tree.advance_top(*(live ? cur[w] : &sentinel), live);
+  }
+  return out;
+}
+
+/// Arithmetic keys: the type's maximum (or +infinity) is the sentinel.
+template <RunRange Runs, class OutputIt>
+  requires std::is_arithmetic_v<run_value_t<Runs>>
+OutputIt sentinel_merge(const Runs& runs, OutputIt out) {
+  using T = run_value_t<Runs>;
+  constexpr T sentinel = std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity()
+                                                              : std::numeric_limits<T>::max();
+  return sentinel_merge(runs, out, sentinel, std::less<>());
+}
+
+}  // namespace nway
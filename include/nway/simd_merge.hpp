@@ -0,0 +1,147 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "detail/simd_common.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define NWAY_HAVE_X86_SIMD 1
+#include "detail/simd_avx2.hpp"
+#include "detail/simd_avx512.hpp"
+#endif
+
+namespace nway {
+
+/// Instruction sets the SIMD merge kernels can use, in increasing order.
+enum class SimdLevel { scalar, avx2, avx512 };
+
+inline const char* to_string(SimdLevel level) {
+  switch (level) {
+    case SimdLevel::avx512: return "avx512";
+    case SimdLevel::avx2: return "avx2";
+    default: return "scalar";
+  }
+}
+
+/// Best level the running CPU supports, detected once.
+inline SimdLevel simd_level() {
+  static const SimdLevel level = [] {
+#ifdef NWAY_HAVE_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return SimdLevel::avx512;
+    if (__builtin_cpu_supports("avx2")) return SimdLevel::avx2;
+#endif
+    return SimdLevel::scalar;
+  }();
+  return level;
+}
+
+/// Key types with bitonic merge kernels. Floats must not be NaN, and the
+/// kernels may interchange -0.0 and +0.0.
+template <class T>
+inline constexpr bool is_simd_key_v =
+    std::is_same_v<T, std::uint32_t> || std::is_same_v<T, std::uint64_t> || std::is_same_v<T, float>;
+
+/// Largest K merged by simd_merge() rather than a loser tree.
+inline constexpr std::size_t kSimdMaxK = 8;
+
+/// Merges two ascending arrays into `out` with the widest kernel allowed by
+/// both `level` and the CPU; returns the end of the output.
+template <class T>
+  requires is_simd_key_v<T>
+T* simd_merge2(const T* a, std::size_t na, const T* b, std::size_t nb, T* out,
+               SimdLevel level = simd_level()) {
+  if (level > simd_level()) level = simd_level();
+#ifdef NWAY_HAVE_X86_SIMD
+  if constexpr (std::is_same_v<T, std::uint32_t>) {
+    if (level == SimdLevel::avx512) return detail::avx512::merge2<detail::avx512::U32>(a, na, b, nb, out);
+    if (level == SimdLevel::avx2) return detail::avx2::merge2<detail::avx2::U32>(a, na, b, nb, out);
+  } else if constexpr (std::is_same_v<T, std::uint64_t>) {
+    if (level == SimdLevel::avx512) return detail::avx512::merge2<detail::avx512::U64>(a, na, b, nb, out);
+    if (level == SimdLevel::avx2) return detail::avx2::merge2<detail::avx2::U64>(a, na, b, nb, out);
+  } else {
+    if (level == SimdLevel::avx512) return detail::avx512::merge2<detail::avx512::F32>(a, na, b, nb, out);
+    if (level == SimdLevel::avx2) return detail::avx2::merge2<detail::avx2::F32>(a, na, b, nb, out);
+  }
+#endif
+  return detail::scalar_merge2(a, na, b, nb, out);
+}
+
+/// simd_merge() with caller-provided scratch of at least the total input
+/// size, for K <= kSimdMaxK: allocates nothing. Rounds of simd_merge2()
+/// alternate between `scratch` and `out` so that the last one lands in `out`.
+template <class T>
+  requires is_simd_key_v<T>
+T* simd_merge(std::span<const std::span<const T>> runs, T* out, T* scratch,
+              SimdLevel level = simd_level()) {
+  if (runs.size() > kSimdMaxK)
+    throw std::invalid_argument("nway::simd_merge: more than kSimdMaxK runs");
+  if (runs.empty()) return out;
+  if (runs.size() == 1) return std::copy(runs[0].begin(), runs[0].end(), out);
+
+  std::array<std::span<const T>, kSimdMaxK> cur, next;
+  std::copy(runs.begin(), runs.end(), cur.begin());
+  std::size_t n = runs.size();
+  // ceil(log2 K) rounds in total; the first writes to `out` iff that is odd.
+  T* buf[2] = {scratch, out};
+  std::size_t target = (std::bit_width(n - 1) & 1) ? 1 : 0;
+  while (n > 2) {
+    T* dst = buf[target];
+    std::size_t m = 0;
+    for (std::size_t i = 0; i + 1 < n; i += 2) {
+      T* end = simd_merge2(cur[i].data(), cur[i].size(), cur[i + 1].data(), cur[i + 1].size(),
+                           dst, level);
+      next[m++] = {dst, end};
+      dst = end;
+    }
+    // An odd run out moves along too, so no round reads the buffer it writes.
+    if (n % 2) next[m++] = {dst, std::copy(cur[n - 1].begin(), cur[n - 1].end(), dst)};
+    cur = next;
+    n = m;
+    target ^= 1;
+  }
+  return simd_merge2(cur[0].data(), cur[0].size(), cur[1].data(), cur[1].size(), out, level);
+}
+
+/// Merges a handful of ascending runs (intended for K <= kSimdMaxK) as a
+/// balanced tree of simd_merge2() calls through a scratch buffer.
+template <class T>
+  requires is_simd_key_v<T>
+T* simd_merge(std::span<const std::span<const T>> runs, T* out, SimdLevel level = simd_level()) {
+  if (runs.empty()) return out;
+  if (runs.size() == 1) return std::copy(runs[0].begin(), runs[0].end(), out);
+  if (runs.size() == 2)
+    return simd_merge2(runs[0].data(), runs[0].size(), runs[1].data(), runs[1].size(), out, level);
+
+  std::size_t total = 0;
+  for (auto r : runs) total += r.size();
+  if (runs.size() <= kSimdMaxK) {
+    std::vector<T> scratch(total);
+    return simd_merge(runs, out, scratch.data(), level);
+  }
+  std::vector<T> scratch[2] = {std::vector<T>(total), std::vector<T>(total)};
+  std::vector<std::span<const T>> cur(runs.begin(), runs.end()), next;
+  for (int round = 0; cur.size() > 2; ++round) {
+    T* dst = scratch[round & 1].data();
+    next.clear();
+    for (std::size_t i = 0; i + 1 < cur.size(); i += 2) {
+      T* end = simd_merge2(cur[i].data(), cur[i].size(), cur[i + 1].data(), cur[i + 1].size(),
+                           dst, level);
+      next.emplace_back(dst, end);
+      dst = end;
+    }
+    if (cur.size() % 2) next.push_back(cur.back());
+    cur.swap(next);
+  }
+  return simd_merge2(cur[0].data(), cur[0].size(), cur[1].data(), cur[1].size(), out, level);
+}
+
+}  // namespace nway
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <vector>
+
+#include "detail/ordered_key.hpp"
+#include "fixed_merge.hpp"
+#include "indexed_merge.hpp"
+#include "run.hpp"
+
+namespace nway {
+
+namespace detail {
+
+// Integer keys in natural order whose merge can carry the source index in
+// the low bits of one 64-bit comparison word.
+template <class Runs, class Compare>
+inline constexpr bool packable_v =
+    is_ordered_int_key_v<run_value_t<Runs>, Compare> &&
+    std::ranges::contiguous_range<std::ranges::range_reference_t<const Runs&>>;
+
+// Merges K runs whose heads are held as packed words
+// (key - lo) << src_bits | run, so the minimum word is the next element in
+// stable order: one unsigned compare per head, no tie-break, and exhausted
+// runs hold an all-ones word that no real word reaches.
+template <std::size_t K, class T, class OutputIt>
+void packed_merge_k(const T** cur, const T* const* end, std::size_t total, std::uint64_t lo,
+                    int src_bits, OutputIt& out, std::uint32_t* sources) {
+  constexpr std::uint64_t kExhausted = ~std::uint64_t(0);
+  const std::uint64_t mask = (std::uint64_t(1) << src_bits) - 1;
+  std::uint64_t heads[K];
+  for (std::size_t i = 0; i < K; ++i)
+    heads[i] = cur[i] != end[i] ? (to_ordered(*cur[i]) - lo) << src_bits | i : kExhausted;
+  const T dummy{};
+  for (std::size_t n = 0; n < total; ++n) {
+    std::uint64_t m = heads[0];
+    for (std::size_t i = 1; i < K; ++i) m = std::min(m, heads[i]);
+    const std::size_t w = m & mask;
+    *out++ = from_ordered<T>((m >> src_bits) + lo);
+    if (sources) *sources++ = static_cast<std::uint32_t>(w);
+    const bool live = ++cur[w] != end[w];
+    const std::uint64_t next = (to_ordered(*(live ? cur[w] : &dummy)) - lo) << src_bits | w;
+    heads[w] = live ? next : kExhausted;
+  }
+}
+
+// Packed-word path of stable_merge for 2 <= K <= kFixedMaxK integer runs.
+// Returns false, having written nothing, when the key range is too wide to
+// leave src_bits free below bit 63.
+template <RunRange Runs, class OutputIt>
+bool packed_stable_merge(const Runs& runs, OutputIt& out, std::uint32_t* sources) {
+  using T = run_value_t<Runs>;
+  const std::size_t k = std::ranges::size(runs);
+  const int src_bits = std::bit_width(k - 1);
+  std::uint64_t lo = std::numeric_limits<std::uint64_t>::max(), hi = 0;
+  std::size_t total = 0;
+  const T* cur[kFixedMaxK];
+  const T* end[kFixedMaxK];
+  for (std::size_t i = 0; i < k; ++i) {
+    cur[i] = std::ranges::data(runs[i]);
+    end[i] = cur[i] + std::ranges::size(runs[i]);
+    if (cur[i] == end[i]) continue;
+    lo = std::min(lo, to_ordered(cur[i][0]));
+    hi = std::max(hi, to_ordered(end[i][-1]));
+    total += end[i] - cur[i];
+  }
+  if (total == 0) return true;
+  if (std::bit_width(hi - lo) + src_bits > 63) return false;
+  switch (k) {
+    case 2: packed_merge_k<2>(cur, end, total, lo, src_bits, out, sources); break;
+    case 3: packed_merge_k<3>(cur, end, total, lo, src_bits, out, sources); break;
+    case 4: packed_merge_k<4>(cur, end, total, lo, src_bits, out, sources); break;
+    case 5: packed_merge_k<5>(cur, end, total, lo, src_bits, out, sources); break;
+    case 6: packed_merge_k<6>(cur, end, total, lo, src_bits, out, sources); break;
+    case 7: packed_merge_k<7>(cur, end, total, lo, src_bits, out, sources); break;
+    default: packed_merge_k<8>(cur, end, total, lo, src_bits, out, sources); break;
+  }
+  return true;
+}
+
+}  // namespace detail
+
+/// Stable merge that also reports provenance: equal keys keep run order and,
+/// when `sources` is not null, sources[i] receives the index of the run the
+/// i-th output element came from.
+///
+/// For integer keys in natural order with K <= kFixedMaxK, each run's head is
+/// held as one 64-bit word with the run index packed below the key's offset
+/// from the smallest key (when the key range leaves ceil(log2 K) bits free),
+/// so selecting the next element is a branch-free minimum over K words with
+/// the tie-break built in. Everything else merges on the two-field
+/// (key, run) order of the loser tree.
+template <RunRange Runs, class OutputIt, class Compare = std::less<>>
+OutputIt stable_merge(const Runs& runs, OutputIt out, std::uint32_t* sources = nullptr,
+                      Compare comp = Compare()) {
+  if constexpr (detail::packable_v<Runs, Compare>) {
+    const std::size_t k = std::ranges::size(runs);
+    if (k >= 2 && k <= kFixedMaxK && detail::packed_stable_merge(runs, out, sources)) return out;
+  }
+  std::identity key;
+  detail::merge_keys(runs, key, comp, [&](std::size_t run, std::size_t offset) {
+    *out++ = runs[run][offset];
+    if (sources) *sources++ = static_cast<std::uint32_t>(run);
+  });
+  return out;
+}
+
+}  // namespace nway
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace nway {
+
+/// What a work_stealing_for() call did, per worker.
+struct WorkStealingStats {
+  std::vector<double> finish_seconds;  ///< when each worker ran out of work, from the start
+  std::vector<std::size_t> tasks_run;  ///< tasks each worker executed
+  std::size_t steals = 0;              ///< successful steal operations
+};
+
+namespace detail {
+
+// One worker's queue: a contiguous range of task ids. The owner takes from
+// the front, in order; a thief takes the back half in one go. Tasks are
+// coarse (whole merge slices), so a mutex per queue is cheap enough.
+class TaskRange {
+ public:
+  void assign(std::size_t first, std::size_t last) {
+    std::lock_guard lock(mutex_);
+    first_ = first;
+    last_ = last;
+  }
+
+  bool pop(std::size_t& task) {
+    std::lock_guard lock(mutex_);
+    if (first_ == last_) return false;
+    task = first_++;
+    return true;
+  }
+
+  bool steal_half(std::size_t& first, std::size_t& last) {
+    std::lock_guard lock(mutex_);
+    if (first_ == last_) return false;
+    const std::size_t mid = first_ + (last_ - first_) / 2;
+    first = mid;
+    last = last_;
+    last_ = mid;
+    return true;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::size_t first_ = 0, last_ = 0;
+};
+
+}  // namespace detail
+
+/// Runs `task(worker, i)` for every i in [0, tasks) on `threads` workers;
+/// worker 0 is the calling thread. Each worker starts with an equal
+/// contiguous block of task ids and works through it in order; a worker
+/// whose block is empty steals the back half of another worker's remaining
+/// block, so a few slow tasks do not leave the others idle. `on_start(worker)`
+/// runs first on each worker and its result is kept alive until that worker
+/// is done. The first exception thrown by a task is rethrown once all workers
+/// have stopped.
+template <class Task, class OnStart>
+void work_stealing_for(std::size_t tasks, std::size_t threads, Task task, OnStart on_start,
+                       WorkStealingStats* stats = nullptr) {
+  threads = std::max<std::size_t>(1, std::min(threads, tasks));
+  std::unique_ptr<detail::TaskRange[]> queues(new detail::TaskRange[threads]);
+  for (std::size_t w = 0; w < threads; ++w)
+    queues[w].assign(tasks * w / threads, tasks * (w + 1) / threads);
+  std::vector<double> finish(threads, 0.0);
+  std::vector<std::size_t> run(threads, 0);
+  std::atomic<std::size_t> steals{0};
+  std::atomic<bool> failed{false};
+  std::vector<std::exception_ptr> errors(threads);
+  const auto start = std::chrono::steady_clock::now();
+
+  auto work = [&](std::size_t w) {
+    try {
+      [[maybe_unused]] auto guard = on_start(w);
+      std::size_t i, first, last;
+      while (!failed.load(std::memory_order_relaxed)) {
+        if (queues[w].pop(i)) {
+          task(w, i);
+          ++run[w];
+          continue;
+        }
+        bool stolen = false;
+        for (std::size_t v = 1; v < threads && !stolen; ++v) {
+          if (queues[(w + v) % threads].steal_half(first, last)) {
+            queues[w].assign(first, last);
+            steals.fetch_add(1, std::memory_order_relaxed);
+            stolen = true;
+          }
+        }
+        if (!stolen) break;
+      }
+    } catch (...) {
+      errors[w] = std::current_exception();
+      failed.store(true, std::memory_order_relaxed);
+    }
+    finish[w] = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  };
+  std::vector<std::thread> pool;
+  pool.reserve(threads - 1);
+  for (std::size_t w = 1; w < threads; ++w) pool.emplace_back(work, w);
+  work(0);
+  for (auto& th : pool) th.join();
+  if (stats) {
+    stats->finish_seconds = std::move(finish);
+    stats->tasks_run = std::move(run);
+    stats->steals = steals.load();
+  }
+  for (auto& e : errors)
+    if (e) std::rethrow_exception(e);
+}
+
+}  // namespace nway
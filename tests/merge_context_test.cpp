@@ -0,0 +1,120 @@
+// A warm MergeContext must not touch the heap. Every replaceable allocation
+// form is counted: the arena and the loser tree's node storage allocate
+// through the aligned overloads. Covers the SIMD, fixed-K and loser tree
+// paths and both merge() overloads.
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <vector>
+
+#include "nway/merge.hpp"
+#include "nway/merge_context.hpp"
+
+namespace {
+
+std::atomic<std::uint64_t> g_allocations{0};
+
+int g_failures = 0;
+
+// Out of line so GCC does not pair the inlined malloc in operator new with
+// this free and warn about a mismatched deallocation.
+[[gnu::noinline]] void release(void* p) noexcept { std::free(p); }
+
+void expect(bool ok, const char* what, std::size_t k) {
+  if (ok) return;
+  std::fprintf(stderr, "FAILED (K=%zu): %s\n", k, what);
+  ++g_failures;
+}
+
+template <class T>
+std::vector<std::vector<T>> random_runs(std::size_t k, std::size_t n, std::uint64_t seed) {
+  std::mt19937_64 rng(seed);
+  std::vector<std::vector<T>> runs(k);
+  for (auto& run : runs) {
+    run.resize(n);
+    for (auto& x : run) x = static_cast<T>(rng() % 1000);  // plenty of ties
+    std::sort(run.begin(), run.end());
+  }
+  return runs;
+}
+
+template <class T>
+void check_no_allocations(std::size_t k) {
+  constexpr std::size_t kQueries = 16, kPerList = 100, kCalls = 1000;
+  std::vector<std::vector<std::vector<T>>> queries;
+  for (std::size_t q = 0; q < kQueries; ++q) queries.push_back(random_runs<T>(k, kPerList, q));
+  std::vector<T> out(k * kPerList);
+
+  nway::MergeContext<T> ctx;
+  for (const auto& q : queries) {
+    ctx.merge(q, out.begin());
+    ctx.merge(q);
+  }
+
+  const std::uint64_t before = g_allocations.load();
+  for (std::size_t c = 0; c < kCalls; ++c) {
+    ctx.merge(queries[c % kQueries], out.begin());
+    ctx.merge(queries[c % kQueries]);
+  }
+  expect(g_allocations.load() == before, "warm MergeContext allocated", k);
+
+  for (const auto& q : queries) {
+    const auto expected = nway::merge_to_vector(q);
+    ctx.merge(q, out.begin());
+    expect(out == expected, "merge into an iterator differs from nway::merge", k);
+    expect(std::ranges::equal(ctx.merge(q), expected), "merge into the arena differs", k);
+  }
+}
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* p = std::malloc(size ? size : 1)) return p;
+  throw std::bad_alloc();
+}
+void* operator new(std::size_t size, std::align_val_t align) {
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  const std::size_t a = static_cast<std::size_t>(align);
+  // aligned_alloc wants a multiple of the alignment.
+  const std::size_t rounded = size == 0 ? a : (size + a - 1) / a * a;
+  if (void* p = std::aligned_alloc(a, rounded)) return p;
+  throw std::bad_alloc();
+}
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  return std::malloc(size ? size : 1);
+}
+void* operator new(std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+  try {
+    return operator new(size, align);
+  } catch (const std::bad_alloc&) {
+    return nullptr;
+  }
+}
+void* operator new[](std::size_t size) { return operator new(size); }
+void* operator new[](std::size_t size, std::align_val_t align) { return operator new(size, align); }
+void operator delete(void* p) noexcept { release(p); }
+void operator delete(void* p, std::size_t) noexcept { release(p); }
+void operator delete(void* p, std::align_val_t) noexcept { release(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { release(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { release(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { release(p); }
+void operator delete[](void* p) noexcept { release(p); }
+void operator delete[](void* p, std::size_t) noexcept { release(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { release(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { release(p); }
+
+int main() {
+  for (std::size_t k : {2, 4, 8, 16, 100}) {
+    check_no_allocations<std::uint64_t>(k);  // SIMD kernels up to kSimdMaxK
+    check_no_allocations<std::int32_t>(k);   // fixed-K merges up to kFixedMaxK
+  }
+  if (g_failures == 0) std::printf("merge_context_test: ok\n");
+  return g_failures == 0 ? 0 : 1;
+}